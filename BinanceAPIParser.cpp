@@ -1,84 +1,14 @@
 #include "BinanceAPIParser.h"
 
+#include "ScaledDecimal.h"
+
 #include <boost/json.hpp>
 #include <boost/system/error_code.hpp>
-#include <charconv>
 #include <initializer_list>
-#include <limits>
 #include <optional>
 #include <string>
 
 namespace {
-std::optional<uint32_t> decimalPlacesFromScale(uint64_t scale) {
-    if (scale == 0) {
-        return std::nullopt;
-    }
-    uint32_t places = 0;
-    while (scale > 1) {
-        if ((scale % 10) != 0) {
-            return std::nullopt;
-        }
-        scale /= 10;
-        ++places;
-    }
-    return places;
-}
-
-std::optional<uint64_t> parseUint(std::string_view s) {
-    if (s.empty()) {
-        return std::nullopt;
-    }
-    uint64_t out = 0;
-    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
-    if (ec != std::errc() || ptr != s.data() + s.size()) {
-        return std::nullopt;
-    }
-    return out;
-}
-
-std::optional<uint64_t> parseScaledDecimal(std::string_view s, uint64_t scale, uint32_t places) {
-    const size_t dot = s.find('.');
-    const std::string_view intPart = (dot == std::string_view::npos) ? s : s.substr(0, dot);
-    std::string_view fracPart =
-        (dot == std::string_view::npos) ? std::string_view{} : s.substr(dot + 1);
-
-    if (intPart.empty()) {
-        return std::nullopt;
-    }
-
-    const auto intValue = parseUint(intPart);
-    if (!intValue) {
-        return std::nullopt;
-    }
-
-    if (fracPart.size() > places) {
-        // Be tolerant when payload has finer precision than configured scale.
-        // Keep the supported precision and drop excess fractional digits.
-        fracPart = fracPart.substr(0, places);
-    }
-
-    uint64_t fracValue = 0;
-    if (!fracPart.empty()) {
-        const auto parsedFrac = parseUint(fracPart);
-        if (!parsedFrac) {
-            return std::nullopt;
-        }
-        fracValue = *parsedFrac;
-    }
-
-    for (size_t i = fracPart.size(); i < places; ++i) {
-        if (fracValue > std::numeric_limits<uint64_t>::max() / 10) {
-            return std::nullopt;
-        }
-        fracValue *= 10;
-    }
-
-    if (*intValue > (std::numeric_limits<uint64_t>::max() - fracValue) / scale) {
-        return std::nullopt;
-    }
-    return (*intValue * scale) + fracValue;
-}
-
 std::optional<uint64_t> parseJsonU64(const boost::json::value& v) {
     if (v.is_uint64()) {
         return v.as_uint64();
@@ -94,7 +24,7 @@ std::optional<uint64_t> parseJsonU64(const boost::json::value& v) {
         return std::nullopt;
     }
     const auto s = v.as_string();
-    return parseUint(std::string_view(s.data(), s.size()));
+    return ScaledDecimal::parseUint(std::string_view(s.data(), s.size()));
 }
 
 std::optional<uint64_t> parseJsonScaled(const boost::json::value& v, uint64_t scale,
@@ -103,7 +33,7 @@ std::optional<uint64_t> parseJsonScaled(const boost::json::value& v, uint64_t sc
         return std::nullopt;
     }
     const auto s = v.as_string();
-    return parseScaledDecimal(std::string_view(s.data(), s.size()), scale, places);
+    return ScaledDecimal::parse(std::string_view(s.data(), s.size()), scale, places);
 }
 
 std::optional<std::vector<Level>> parseJsonSide(const boost::json::value& sideValue,
@@ -145,48 +75,123 @@ const boost::json::value* firstExisting(const boost::json::object& obj,
 } // namespace
 
 OrderBookDelta BinanceAPIParser::parseDelta(std::string_view input) const {
+    auto update = parseDepthUpdate(input);
+    if (!update) {
+        return {};
+    }
+    return std::move(update->delta);
+}
+
+std::optional<BinanceAPIParser::DepthUpdate> BinanceAPIParser::parseDepthUpdate(
+    std::string_view input) const {
+    if (pricePlaces_ && qtyPlaces_) {
+        DepthUpdate update;
+        if (scanner_.scanDepthUpdate(input, update.delta, update.previousLastUpdate)) {
+            const auto& delta = update.delta;
+            if (delta.firstUpdate == 0 || delta.lastUpdate == 0 ||
+                delta.firstUpdate > delta.lastUpdate) {
+                return std::nullopt;
+            }
+            return update;
+        }
+    }
+    return parseDepthUpdateJson(input);
+}
+
+std::optional<BinanceAPIParser::UpdateIds> BinanceAPIParser::parseUpdateIds(
+    std::string_view input) const {
+    if (pricePlaces_ && qtyPlaces_) {
+        UpdateIds ids;
+        if (scanner_.scanUpdateIds(input, ids.firstUpdate, ids.lastUpdate,
+                                   ids.previousLastUpdate)) {
+            if (ids.firstUpdate == 0 || ids.lastUpdate == 0 || ids.firstUpdate > ids.lastUpdate) {
+                return std::nullopt;
+            }
+            return ids;
+        }
+    }
+    auto update = parseDepthUpdateJson(input);
+    if (!update) {
+        return std::nullopt;
+    }
+    return UpdateIds{
+        .firstUpdate = update->delta.firstUpdate,
+        .lastUpdate = update->delta.lastUpdate,
+        .previousLastUpdate = update->previousLastUpdate,
+    };
+}
+
+OrderBookSnapshot BinanceAPIParser::parseSnapshot(std::string_view input) const {
+    if (pricePlaces_ && qtyPlaces_) {
+        OrderBookSnapshot snapshot;
+        if (scanner_.scanSnapshot(input, snapshot)) {
+            return snapshot;
+        }
+    }
+    return parseSnapshotJson(input);
+}
+
+std::optional<BinanceAPIParser::DepthUpdate> BinanceAPIParser::parseDepthUpdateJson(
+    std::string_view input) const {
     namespace json = boost::json;
     boost::system::error_code parseError;
     json::value parsed = json::parse(input, parseError);
     if (parseError || !parsed.is_object()) {
-        return {};
+        return std::nullopt;
     }
 
     const auto& obj = parsed.as_object();
     const auto* firstUpdate = firstExisting(obj, {"U", "firstUpdateId"});
     const auto* lastUpdate = firstExisting(obj, {"u", "finalUpdateId"});
+    const auto* previousLastUpdate = obj.if_contains("pu");
+    const auto* eventTime = obj.if_contains("E");
+    const auto* transactionTime = obj.if_contains("T");
     const auto* bids = firstExisting(obj, {"b", "bids"});
     const auto* asks = firstExisting(obj, {"a", "asks"});
 
     if (!firstUpdate || !lastUpdate || !bids || !asks) {
-        return {};
+        return std::nullopt;
     }
 
-    const auto pricePlaces = decimalPlacesFromScale(scales_.priceScale);
-    const auto qtyPlaces = decimalPlacesFromScale(scales_.qtyScale);
-    if (!pricePlaces || !qtyPlaces) {
-        return {};
+    if (!pricePlaces_ || !qtyPlaces_) {
+        return std::nullopt;
     }
 
     const auto parsedFirstUpdate = parseJsonU64(*firstUpdate);
     const auto parsedLastUpdate = parseJsonU64(*lastUpdate);
-    const auto parsedBids =
-        parseJsonSide(*bids, scales_.priceScale, scales_.qtyScale, *pricePlaces, *qtyPlaces);
-    const auto parsedAsks =
-        parseJsonSide(*asks, scales_.priceScale, scales_.qtyScale, *pricePlaces, *qtyPlaces);
-    if (!parsedFirstUpdate || !parsedLastUpdate || !parsedBids || !parsedAsks) {
-        return {};
+    if (!parsedFirstUpdate || !parsedLastUpdate || *parsedFirstUpdate == 0 ||
+        *parsedLastUpdate == 0 || *parsedFirstUpdate > *parsedLastUpdate) {
+        return std::nullopt;
+    }
+    std::optional<uint64_t> parsedPreviousLastUpdate;
+    if (previousLastUpdate) {
+        parsedPreviousLastUpdate = parseJsonU64(*previousLastUpdate);
     }
 
-    return OrderBookDelta{
-        .firstUpdate = *parsedFirstUpdate,
-        .lastUpdate = *parsedLastUpdate,
-        .bids = std::move(*parsedBids),
-        .asks = std::move(*parsedAsks),
+    auto parsedBids =
+        parseJsonSide(*bids, scales_.priceScale, scales_.qtyScale, *pricePlaces_, *qtyPlaces_);
+    auto parsedAsks =
+        parseJsonSide(*asks, scales_.priceScale, scales_.qtyScale, *pricePlaces_, *qtyPlaces_);
+    if (!parsedBids || !parsedAsks) {
+        return std::nullopt;
+    }
+
+    return DepthUpdate{
+        .delta =
+            OrderBookDelta{
+                .firstUpdate = *parsedFirstUpdate,
+                .lastUpdate = *parsedLastUpdate,
+                .bids = std::move(*parsedBids),
+                .asks = std::move(*parsedAsks),
+                .eventTimeMs = eventTime ? parseJsonU64(*eventTime).value_or(0) : 0,
+                .transactionTimeMs =
+                    transactionTime ? parseJsonU64(*transactionTime).value_or(0) : 0,
+            },
+        .previousLastUpdate = parsedPreviousLastUpdate,
     };
 }
 
-OrderBookSnapshot BinanceAPIParser::parseSnapshot(std::string_view input) const {
+OrderBookSnapshot BinanceAPIParser::parseSnapshotJson(std::string_view input) const {
     namespace json = boost::json;
     boost::system::error_code parseError;
     json::value parsed = json::parse(input, parseError);
@@ -201,17 +206,15 @@ OrderBookSnapshot BinanceAPIParser::parseSnapshot(std::string_view input) const
         return {};
     }
 
-    const auto pricePlaces = decimalPlacesFromScale(scales_.priceScale);
-    const auto qtyPlaces = decimalPlacesFromScale(scales_.qtyScale);
-    if (!pricePlaces || !qtyPlaces) {
+    if (!pricePlaces_ || !qtyPlaces_) {
         return {};
     }
 
     const auto parsedLastUpdate = parseJsonU64(*lastUpdateId);
     const auto parsedBids =
-        parseJsonSide(*bids, scales_.priceScale, scales_.qtyScale, *pricePlaces, *qtyPlaces);
+        parseJsonSide(*bids, scales_.priceScale, scales_.qtyScale, *pricePlaces_, *qtyPlaces_);
     const auto parsedAsks =
-        parseJsonSide(*asks, scales_.priceScale, scales_.qtyScale, *pricePlaces, *qtyPlaces);
+        parseJsonSide(*asks, scales_.priceScale, scales_.qtyScale, *pricePlaces_, *qtyPlaces_);
     if (!parsedLastUpdate || !parsedBids || !parsedAsks) {
         return {};
     }
@@ -231,7 +234,7 @@ std::string BinanceAPIParser::formatQty(Qty qty) const {
 }
 
 std::string BinanceAPIParser::formatScaled(uint64_t value, uint64_t scale) {
-    const auto places = decimalPlacesFromScale(scale);
+    const auto places = ScaledDecimal::placesFromScale(scale);
     if (!places || *places == 0) {
         return std::to_string(value);
     }
@@ -1,22 +1,53 @@
 #pragma once
 
+#include "BinanceDepthScanner.h"
+#include "ScaledDecimal.h"
 #include "Types.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 
 class BinanceAPIParser {
   public:
+    // A depthUpdate event: the levels plus the `pu` sequence field that only
+    // the stream carries.
+    struct DepthUpdate {
+        OrderBookDelta delta;
+        std::optional<uint64_t> previousLastUpdate;
+    };
+
+    // Just the sequence fields of a depthUpdate event.
+    struct UpdateIds {
+        uint64_t firstUpdate = 0;
+        uint64_t lastUpdate = 0;
+        std::optional<uint64_t> previousLastUpdate;
+    };
+
     explicit BinanceAPIParser(SymbolScales scales)
-        : scales_(scales) {
+        : scales_(scales),
+          pricePlaces_(ScaledDecimal::placesFromScale(scales.priceScale)),
+          qtyPlaces_(ScaledDecimal::placesFromScale(scales.qtyScale)),
+          scanner_(scales, pricePlaces_.value_or(0), qtyPlaces_.value_or(0)) {
     }
 
     OrderBookDelta parseDelta(std::string_view payload) const;
+    // Decodes sequence ids and levels in a single pass over the payload.
+    std::optional<DepthUpdate> parseDepthUpdate(std::string_view payload) const;
+    // Validates like parseDepthUpdate() but leaves the levels undecoded.
+    std::optional<UpdateIds> parseUpdateIds(std::string_view payload) const;
     OrderBookSnapshot parseSnapshot(std::string_view payload) const;
     std::string formatPrice(Price price) const;
     std::string formatQty(Qty qty) const;
     static std::string formatScaled(uint64_t value, uint64_t scale);
 
   private:
+    std::optional<DepthUpdate> parseDepthUpdateJson(std::string_view payload) const;
+    OrderBookSnapshot parseSnapshotJson(std::string_view payload) const;
+
     SymbolScales scales_{};
+    std::optional<uint32_t> pricePlaces_;
+    std::optional<uint32_t> qtyPlaces_;
+    BinanceDepthScanner scanner_;
 };
@@ -0,0 +1,267 @@
+#include "BinanceCombinedMarketData.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+// Binance caps the number of streams a single combined connection may carry.
+constexpr std::size_t kMaxStreamsPerConnection = 200;
+
+std::string toLowerCopy(std::string_view value) {
+    std::string out(value);
+    std::transform(out.begin(), out.end(), out.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+
+// Binance always emits the envelope as `{"stream":"...","data":...}`, so the
+// split is done by position rather than with a JSON parser.
+bool splitEnvelope(std::string_view text, std::string_view& stream, std::string_view& data) {
+    constexpr std::string_view kStreamKey = "{\"stream\":\"";
+    constexpr std::string_view kDataKey = "\",\"data\":";
+
+    if (!text.starts_with(kStreamKey)) {
+        return false;
+    }
+    const auto streamEnd = text.find('"', kStreamKey.size());
+    if (streamEnd == std::string_view::npos ||
+        text.compare(streamEnd, kDataKey.size(), kDataKey) != 0) {
+        return false;
+    }
+    stream = text.substr(kStreamKey.size(), streamEnd - kStreamKey.size());
+
+    const auto dataBegin = streamEnd + kDataKey.size();
+    const auto dataEnd = text.find_last_of('}');
+    if (dataEnd == std::string_view::npos || dataEnd <= dataBegin) {
+        return false;
+    }
+    data = text.substr(dataBegin, dataEnd - dataBegin);
+    return true;
+}
+} // namespace
+
+class BinanceCombinedMarketData::Channel : public ILiveMarketData {
+  public:
+    Channel(std::string key, std::size_t feeds)
+        : key_(std::move(key)),
+          arbiter_(feeds > 1 ? std::make_unique<FeedArbiter>(feeds) : nullptr) {
+    }
+
+    void start(std::string_view symbol, OnText onText) override final {
+        startFrames(symbol, [onText = std::move(onText)](FrameRef frame) {
+            onText(std::string(frame.text()));
+        });
+    }
+
+    // The channel is bound to its symbol; the argument is ignored.
+    void startFrames(std::string_view, OnFrame onFrame) override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onFrame_ = std::move(onFrame);
+    }
+
+    void stop() override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onFrame_ = nullptr;
+    }
+
+    void setOnLinkState(OnLinkState onLinkState) override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onLinkState_ = std::move(onLinkState);
+    }
+
+    void notifyLinkState(LinkState state) {
+        OnLinkState onLinkState;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            onLinkState = onLinkState_;
+        }
+        if (onLinkState) {
+            onLinkState(state);
+        }
+    }
+
+    // With an arbiter a frame may go out later, or release held ones.
+    void deliver(std::size_t feed, FrameRef frame) {
+        if (!arbiter_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (onFrame_) {
+                onFrame_(std::move(frame));
+            }
+            return;
+        }
+        thread_local std::vector<FrameRef> ready;
+        arbiter_->accept(feed, std::move(frame), std::chrono::steady_clock::now(), ready);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (onFrame_) {
+                for (auto& next : ready) {
+                    onFrame_(std::move(next));
+                }
+            }
+        }
+        ready.clear();
+    }
+
+    std::string_view key() const {
+        return key_;
+    }
+    const FeedArbiter* arbiter() const {
+        return arbiter_.get();
+    }
+
+  private:
+    const std::string key_;
+    const std::unique_ptr<FeedArbiter> arbiter_;
+    std::mutex mutex_;
+    OnFrame onFrame_;
+    OnLinkState onLinkState_;
+};
+
+BinanceCombinedMarketData::BinanceCombinedMarketData(boost::asio::io_context& ioContext,
+                                                     std::vector<std::string> symbols,
+                                                     uint64_t updateSpeedMs, std::size_t feeds,
+                                                     std::vector<std::string> endpoints,
+                                                     BinanceHosts hosts)
+    : ioContext_(ioContext),
+      updateSpeedMs_(updateSpeedMs),
+      feeds_(std::max<std::size_t>(1, feeds)),
+      endpoints_(std::move(endpoints)),
+      hosts_(std::move(hosts)) {
+    channels_.reserve(symbols.size());
+    for (const auto& symbol : symbols) {
+        std::string key = toLowerCopy(symbol);
+        if (routes_.contains(key)) {
+            continue;
+        }
+        channels_.push_back(std::make_unique<Channel>(std::move(key), feeds_));
+        routes_.emplace(channels_.back()->key(), channels_.back().get());
+        symbols_.emplace_back(channels_.back()->key());
+    }
+}
+
+BinanceCombinedMarketData::~BinanceCombinedMarketData() {
+    stop();
+}
+
+void BinanceCombinedMarketData::start() {
+    stop();
+    connections_.clear();
+    {
+        std::lock_guard<std::mutex> lock(linkMutex_);
+        groups_.clear();
+    }
+
+    for (std::size_t first = 0; first < symbols_.size(); first += kMaxStreamsPerConnection) {
+        const std::size_t last = std::min(symbols_.size(), first + kMaxStreamsPerConnection);
+        const std::vector<std::string> group(symbols_.begin() + static_cast<std::ptrdiff_t>(first),
+                                             symbols_.begin() + static_cast<std::ptrdiff_t>(last));
+
+        std::size_t groupIndex = 0;
+        {
+            std::lock_guard<std::mutex> lock(linkMutex_);
+            groupIndex = groups_.size();
+            groups_.push_back(Group{.first = first, .last = last, .feedsUp = 0});
+        }
+        for (std::size_t feed = 0; feed < feeds_; ++feed) {
+            std::string address = endpoints_.empty() ? std::string{}
+                                                     : endpoints_[feed % endpoints_.size()];
+            auto connection = std::make_unique<BinanceLiveMarketData>(
+                ioContext_, updateSpeedMs_, std::move(address), hosts_);
+            connection->setOnLinkState([this, groupIndex](ILiveMarketData::LinkState state) {
+                onLinkState(groupIndex, state);
+            });
+            connection->startStreams(group, [this, feed](FrameRef frame) {
+                route(feed, std::move(frame));
+            });
+            connections_.push_back(std::move(connection));
+        }
+    }
+}
+
+void BinanceCombinedMarketData::stop() {
+    for (auto& connection : connections_) {
+        connection->stop();
+    }
+}
+
+ILiveMarketData& BinanceCombinedMarketData::channel(std::string_view symbol) {
+    const std::string key = toLowerCopy(symbol);
+    const auto it = routes_.find(key);
+    if (it == routes_.end()) {
+        throw std::out_of_range("No combined stream channel for symbol " + std::string(symbol));
+    }
+    return *it->second;
+}
+
+BinanceLiveMarketData::LinkStats BinanceCombinedMarketData::linkStats() const {
+    BinanceLiveMarketData::LinkStats total;
+    for (const auto& connection : connections_) {
+        total += connection->linkStats();
+    }
+    return total;
+}
+
+// A group is down only once every feed carrying it is down, and up again
+// with the first feed back; redundant feeds hide single-link outages.
+void BinanceCombinedMarketData::onLinkState(std::size_t groupIndex,
+                                            ILiveMarketData::LinkState state) {
+    bool changed = false;
+    std::size_t first = 0;
+    std::size_t last = 0;
+    {
+        std::lock_guard<std::mutex> lock(linkMutex_);
+        if (groupIndex >= groups_.size()) {
+            return;
+        }
+        auto& group = groups_[groupIndex];
+        if (state == ILiveMarketData::LinkState::Up) {
+            changed = group.feedsUp++ == 0;
+        } else if (group.feedsUp > 0) {
+            changed = --group.feedsUp == 0;
+        }
+        first = group.first;
+        last = group.last;
+    }
+    if (!changed) {
+        return;
+    }
+    for (std::size_t i = first; i < last; ++i) {
+        channels_[i]->notifyLinkState(state);
+    }
+}
+
+std::vector<FeedArbiter::FeedStats> BinanceCombinedMarketData::feedStats() const {
+    std::vector<FeedArbiter::FeedStats> total;
+    for (const auto& channel : channels_) {
+        if (!channel->arbiter()) {
+            continue;
+        }
+        const auto stats = channel->arbiter()->stats();
+        total.resize(stats.size());
+        for (std::size_t feed = 0; feed < stats.size(); ++feed) {
+            total[feed] += stats[feed];
+        }
+    }
+    return total;
+}
+
+void BinanceCombinedMarketData::route(std::size_t feed, FrameRef frame) {
+    std::string_view stream;
+    std::string_view data;
+    if (!splitEnvelope(frame.text(), stream, data)) {
+        unroutedFrames_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto it = routes_.find(stream.substr(0, stream.find('@')));
+    if (it == routes_.end()) {
+        unroutedFrames_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    it->second->deliver(feed, frame.slice(data));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "BinanceLiveMarketData.h"
+#include "FeedArbiter.h"
+#include "ILiveMarketData.h"
+
+#include <boost/asio/io_context.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Shares combined-stream connections between many symbols. Frames arrive as
+// `{"stream":"btcusdt@depth@100ms","data":{...}}`; the envelope is peeled off
+// in place and the `data` slice is handed to the channel of that symbol.
+// Channels are ILiveMarketData views, so each BinanceOrderBookSync starts
+// and stops its channel on resync without touching the shared connection.
+// With `feeds` > 1 every group of streams is carried by that many parallel
+// connections, spread over `endpoints` when given, and each channel
+// forwards only the first copy of every update.
+class BinanceCombinedMarketData {
+  public:
+    BinanceCombinedMarketData(boost::asio::io_context& ioContext, std::vector<std::string> symbols,
+                              uint64_t updateSpeedMs = 100, std::size_t feeds = 1,
+                              std::vector<std::string> endpoints = {}, BinanceHosts hosts = {});
+    ~BinanceCombinedMarketData();
+    BinanceCombinedMarketData(const BinanceCombinedMarketData&) = delete;
+    BinanceCombinedMarketData& operator=(const BinanceCombinedMarketData&) = delete;
+
+    void start();
+    void stop();
+
+    // Throws std::out_of_range for symbols not passed to the constructor.
+    ILiveMarketData& channel(std::string_view symbol);
+
+    std::size_t connections() const {
+        return connections_.size();
+    }
+    uint64_t unroutedFrames() const {
+        return unroutedFrames_.load(std::memory_order_relaxed);
+    }
+    BinanceLiveMarketData::LinkStats linkStats() const;
+    // Per feed, summed over channels; empty with a single feed.
+    std::vector<FeedArbiter::FeedStats> feedStats() const;
+
+  private:
+    class Channel;
+
+    // Streams [first, last) of `symbols_`, carried by `feeds_` connections.
+    struct Group {
+        std::size_t first = 0;
+        std::size_t last = 0;
+        std::size_t feedsUp = 0;
+    };
+
+    void route(std::size_t feed, FrameRef frame);
+    void onLinkState(std::size_t groupIndex, ILiveMarketData::LinkState state);
+
+    boost::asio::io_context& ioContext_;
+    uint64_t updateSpeedMs_;
+    std::size_t feeds_;
+    std::vector<std::string> endpoints_;
+    BinanceHosts hosts_;
+    std::vector<std::string> symbols_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    // Keys view the lowercased symbol owned by each channel.
+    std::unordered_map<std::string_view, Channel*> routes_;
+    std::vector<std::unique_ptr<BinanceLiveMarketData>> connections_;
+    std::mutex linkMutex_;
+    std::vector<Group> groups_;
+    std::atomic<uint64_t> unroutedFrames_{0};
+};
@@ -0,0 +1,339 @@
+#include "BinanceDepthScanner.h"
+
+#include "ScaledDecimal.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace {
+class Cursor {
+  public:
+    explicit Cursor(std::string_view input)
+        : p_(input.data()), end_(input.data() + input.size()) {
+    }
+
+    bool consume(char c) {
+        skipWs();
+        if (p_ == end_ || *p_ != c) {
+            return false;
+        }
+        ++p_;
+        return true;
+    }
+
+    bool peek(char c) {
+        skipWs();
+        return p_ != end_ && *p_ == c;
+    }
+
+    bool atEnd() {
+        skipWs();
+        return p_ == end_;
+    }
+
+    // Plain string without escapes; the view points into the payload.
+    bool readString(std::string_view& out) {
+        if (!consume('"')) {
+            return false;
+        }
+        const char* begin = p_;
+        while (p_ != end_ && *p_ != '"') {
+            if (*p_ == '\\') {
+                return false;
+            }
+            ++p_;
+        }
+        if (p_ == end_) {
+            return false;
+        }
+        out = std::string_view(begin, static_cast<std::size_t>(p_ - begin));
+        ++p_;
+        return true;
+    }
+
+    bool readKey(std::string_view& key) {
+        return readString(key) && consume(':');
+    }
+
+    bool readUint(uint64_t& out) {
+        skipWs();
+        const char* begin = p_;
+        uint64_t value = 0;
+        while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+            const auto digit = static_cast<uint64_t>(*p_ - '0');
+            if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+                return false;
+            }
+            value = value * 10 + digit;
+            ++p_;
+        }
+        if (p_ == begin || (p_ != end_ && (*p_ == '.' || *p_ == 'e' || *p_ == 'E'))) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    // Skips any JSON value the schema does not care about.
+    bool skipValue() {
+        skipWs();
+        if (p_ == end_) {
+            return false;
+        }
+        if (*p_ == '"') {
+            return skipString();
+        }
+        if (*p_ != '{' && *p_ != '[') {
+            while (p_ != end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' && !isWs(*p_)) {
+                ++p_;
+            }
+            return true;
+        }
+
+        std::size_t depth = 0;
+        while (p_ != end_) {
+            const char c = *p_;
+            if (c == '"') {
+                if (!skipString()) {
+                    return false;
+                }
+                continue;
+            }
+            ++p_;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    static bool isWs(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void skipWs() {
+        while (p_ != end_ && isWs(*p_)) {
+            ++p_;
+        }
+    }
+
+    bool skipString() {
+        ++p_;
+        while (p_ != end_ && *p_ != '"') {
+            if (*p_ == '\\' && ++p_ == end_) {
+                return false;
+            }
+            ++p_;
+        }
+        if (p_ == end_) {
+            return false;
+        }
+        ++p_;
+        return true;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+// `[["price","qty"], ...]`. Rows are tokenized first and their numeric
+// strings converted in two batches, one per scale.
+bool scanSide(Cursor& cursor, std::vector<Level>& out, const SymbolScales& scales,
+              uint32_t pricePlaces, uint32_t qtyPlaces) {
+    thread_local std::vector<std::string_view> priceText;
+    thread_local std::vector<std::string_view> qtyText;
+    thread_local std::vector<uint64_t> values;
+    priceText.clear();
+    qtyText.clear();
+    out.clear();
+
+    if (!cursor.consume('[')) {
+        return false;
+    }
+    if (!cursor.consume(']')) {
+        do {
+            std::string_view price;
+            std::string_view qty;
+            if (!cursor.consume('[') || !cursor.readString(price) || !cursor.consume(',') ||
+                !cursor.readString(qty) || !cursor.consume(']')) {
+                return false;
+            }
+            priceText.push_back(price);
+            qtyText.push_back(qty);
+        } while (cursor.consume(','));
+
+        if (!cursor.consume(']')) {
+            return false;
+        }
+    }
+
+    const std::size_t rows = priceText.size();
+    values.resize(rows * 2);
+    if (!ScaledDecimal::parseBatch(priceText.data(), values.data(), rows, scales.priceScale,
+                                   pricePlaces) ||
+        !ScaledDecimal::parseBatch(qtyText.data(), values.data() + rows, rows, scales.qtyScale,
+                                   qtyPlaces)) {
+        return false;
+    }
+
+    out.resize(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        out[i] = Level{.price = values[i], .qty = values[rows + i]};
+    }
+    return true;
+}
+} // namespace
+
+bool BinanceDepthScanner::scanDepthUpdate(std::string_view payload, OrderBookDelta& delta,
+                                          std::optional<uint64_t>& previousLastUpdate) const {
+    Cursor cursor(payload);
+    if (!cursor.consume('{')) {
+        return false;
+    }
+
+    bool hasFirst = false;
+    bool hasLast = false;
+    bool hasBids = false;
+    bool hasAsks = false;
+    previousLastUpdate.reset();
+
+    if (!cursor.peek('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.readKey(key)) {
+                return false;
+            }
+            bool ok = true;
+            if (key == "U" || key == "firstUpdateId") {
+                ok = cursor.readUint(delta.firstUpdate);
+                hasFirst = true;
+            } else if (key == "u" || key == "finalUpdateId") {
+                ok = cursor.readUint(delta.lastUpdate);
+                hasLast = true;
+            } else if (key == "pu") {
+                uint64_t pu = 0;
+                ok = cursor.readUint(pu);
+                previousLastUpdate = pu;
+            } else if (key == "E") {
+                ok = cursor.readUint(delta.eventTimeMs);
+            } else if (key == "T") {
+                ok = cursor.readUint(delta.transactionTimeMs);
+            } else if (key == "b" || key == "bids") {
+                ok = scanSide(cursor, delta.bids, scales_, pricePlaces_, qtyPlaces_);
+                hasBids = true;
+            } else if (key == "a" || key == "asks") {
+                ok = scanSide(cursor, delta.asks, scales_, pricePlaces_, qtyPlaces_);
+                hasAsks = true;
+            } else {
+                ok = cursor.skipValue();
+            }
+            if (!ok) {
+                return false;
+            }
+        } while (cursor.consume(','));
+    }
+
+    if (!cursor.consume('}') || !cursor.atEnd()) {
+        return false;
+    }
+    return hasFirst && hasLast && hasBids && hasAsks;
+}
+
+bool BinanceDepthScanner::scanUpdateIds(std::string_view payload, uint64_t& firstUpdate,
+                                        uint64_t& lastUpdate,
+                                        std::optional<uint64_t>& previousLastUpdate) const {
+    Cursor cursor(payload);
+    if (!cursor.consume('{')) {
+        return false;
+    }
+
+    bool hasFirst = false;
+    bool hasLast = false;
+    bool hasBids = false;
+    bool hasAsks = false;
+    previousLastUpdate.reset();
+
+    if (!cursor.peek('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.readKey(key)) {
+                return false;
+            }
+            bool ok = true;
+            if (key == "U" || key == "firstUpdateId") {
+                ok = cursor.readUint(firstUpdate);
+                hasFirst = true;
+            } else if (key == "u" || key == "finalUpdateId") {
+                ok = cursor.readUint(lastUpdate);
+                hasLast = true;
+            } else if (key == "pu") {
+                uint64_t pu = 0;
+                ok = cursor.readUint(pu);
+                previousLastUpdate = pu;
+            } else if (key == "b" || key == "bids") {
+                ok = cursor.peek('[') && cursor.skipValue();
+                hasBids = true;
+            } else if (key == "a" || key == "asks") {
+                ok = cursor.peek('[') && cursor.skipValue();
+                hasAsks = true;
+            } else {
+                ok = cursor.skipValue();
+            }
+            if (!ok) {
+                return false;
+            }
+        } while (cursor.consume(','));
+    }
+
+    if (!cursor.consume('}') || !cursor.atEnd()) {
+        return false;
+    }
+    return hasFirst && hasLast && hasBids && hasAsks;
+}
+
+bool BinanceDepthScanner::scanSnapshot(std::string_view payload, OrderBookSnapshot& snapshot) const {
+    Cursor cursor(payload);
+    if (!cursor.consume('{')) {
+        return false;
+    }
+
+    bool hasLast = false;
+    bool hasBids = false;
+    bool hasAsks = false;
+
+    if (!cursor.peek('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.readKey(key)) {
+                return false;
+            }
+            bool ok = true;
+            if (key == "lastUpdateId") {
+                ok = cursor.readUint(snapshot.lastUpdate);
+                hasLast = true;
+            } else if (key == "bids") {
+                ok = scanSide(cursor, snapshot.bids, scales_, pricePlaces_, qtyPlaces_);
+                hasBids = true;
+            } else if (key == "asks") {
+                ok = scanSide(cursor, snapshot.asks, scales_, pricePlaces_, qtyPlaces_);
+                hasAsks = true;
+            } else {
+                ok = cursor.skipValue();
+            }
+            if (!ok) {
+                return false;
+            }
+        } while (cursor.consume(','));
+    }
+
+    if (!cursor.consume('}') || !cursor.atEnd()) {
+        return false;
+    }
+    return hasLast && hasBids && hasAsks;
+}
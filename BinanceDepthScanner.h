@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Types.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Hand-rolled tokenizer for the fixed Binance depth schemas: the
+// `depthUpdate` stream event and the `/fapi/v1/depth` snapshot body. Levels
+// are decoded straight from the payload into fixed-point values without a
+// DOM or intermediate strings. Any shape the scanner does not expect (escaped
+// strings, quoted ids, extra row fields, ...) makes it return false so the
+// caller can fall back to the generic JSON path.
+class BinanceDepthScanner {
+  public:
+    BinanceDepthScanner(SymbolScales scales, uint32_t pricePlaces, uint32_t qtyPlaces)
+        : scales_(scales), pricePlaces_(pricePlaces), qtyPlaces_(qtyPlaces) {
+    }
+
+    bool scanDepthUpdate(std::string_view payload, OrderBookDelta& delta,
+                         std::optional<uint64_t>& previousLastUpdate) const;
+    // Sequence fields only; the level arrays are checked for shape and
+    // skipped without decoding.
+    bool scanUpdateIds(std::string_view payload, uint64_t& firstUpdate, uint64_t& lastUpdate,
+                       std::optional<uint64_t>& previousLastUpdate) const;
+    bool scanSnapshot(std::string_view payload, OrderBookSnapshot& snapshot) const;
+
+  private:
+    SymbolScales scales_{};
+    uint32_t pricePlaces_ = 0;
+    uint32_t qtyPlaces_ = 0;
+};
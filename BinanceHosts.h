@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+// Where the Binance clients connect. The defaults are production; a local
+// stand-in such as the mock exchange in bench/ overrides them.
+struct BinanceHosts {
+    std::string rest = "fapi.binance.com";
+    std::string restPort = "443";
+    std::string stream = "fstream.binance.com";
+    std::string streamPort = "443";
+    // PEM bundle trusted in addition to the system store.
+    std::string caFile;
+};
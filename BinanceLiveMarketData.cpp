@@ -12,6 +12,8 @@
 #include <iostream>
 #include <atomic>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
 
 namespace {
@@ -22,16 +24,26 @@ namespace ws = beast::websocket;
 using tcp = asio::ip::tcp;
 } // namespace
 
+// One connection attempt and, if it succeeds, the stream read loop. Every
+// outcome is reported to the supervisor; a session is never reused.
 struct BinanceLiveMarketData::Session : public std::enable_shared_from_this<Session> {
-    Session(asio::io_context& io, ssl::context& tls, std::string host, std::string port,
-            std::string target, OnText onText)
-        : strand_(asio::make_strand(io)),
+    using Strand = asio::strand<asio::io_context::executor_type>;
+
+    Session(Strand strand, ssl::context& tls, std::string host, std::string address,
+            std::string port, std::string target, OnFrame onFrame,
+            std::chrono::milliseconds staleAfter, std::weak_ptr<Supervisor> supervisor)
+        : strand_(std::move(strand)),
           resolver_(strand_),
           ws_(strand_, tls),
           host_(std::move(host)),
+          address_(std::move(address)),
           port_(std::move(port)),
           target_(std::move(target)),
-          onText_(std::move(onText)) {
+          onFrame_(std::move(onFrame)),
+          staleAfter_(staleAfter),
+          supervisor_(std::move(supervisor)),
+          frames_(FrameBufferPool::create()),
+          lease_(frames_->acquire()) {
     }
 
     void startAsync() {
@@ -43,18 +55,25 @@ struct BinanceLiveMarketData::Session : public std::enable_shared_from_this<Sess
         asio::post(strand_, [self = shared_from_this()]() { self->close(); });
     }
 
+    // Last frame or control frame; read on the strand.
+    std::chrono::steady_clock::time_point lastActivity() const {
+        return lastActivity_;
+    }
+
   private:
     void start() {
         if (callbacksSuppressed_.load()) {
             return;
         }
-        resolver_.async_resolve(host_, port_,
+        // A pinned address only replaces the DNS lookup; SNI, certificate
+        // verification and the Host header still use the host name.
+        resolver_.async_resolve(address_.empty() ? host_ : address_, port_,
                                 beast::bind_front_handler(&Session::onResolve, shared_from_this()));
     }
 
     void close() {
         resolver_.cancel();
-        onText_ = nullptr;
+        onFrame_ = nullptr;
 
         beast::error_code ignored;
         auto& socket = beast::get_lowest_layer(ws_).socket();
@@ -74,9 +93,11 @@ struct BinanceLiveMarketData::Session : public std::enable_shared_from_this<Sess
         });
     }
 
+    void fail(std::string_view what, beast::error_code ec);
+
     void onResolve(beast::error_code ec, const tcp::resolver::results_type& results) {
         if (ec) {
-            std::cerr << "BinanceLiveMarketData resolve failed: " << ec.message() << '\n';
+            fail("resolve", ec);
             return;
         }
         beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(10));
@@ -86,11 +107,12 @@ struct BinanceLiveMarketData::Session : public std::enable_shared_from_this<Sess
 
     void onConnect(beast::error_code ec, const tcp::resolver::results_type::endpoint_type&) {
         if (ec) {
-            std::cerr << "BinanceLiveMarketData connect failed: " << ec.message() << '\n';
+            fail("connect", ec);
             return;
         }
         if (!SSL_set_tlsext_host_name(ws_.next_layer().native_handle(), host_.c_str())) {
-            std::cerr << "BinanceLiveMarketData SNI setup failed\n";
+            fail("SNI setup", beast::error_code(static_cast<int>(::ERR_get_error()),
+                                                asio::error::get_ssl_category()));
             return;
         }
 
@@ -103,65 +125,277 @@ struct BinanceLiveMarketData::Session : public std::enable_shared_from_this<Sess
 
     void onTlsHandshake(beast::error_code ec) {
         if (ec) {
-            std::cerr << "BinanceLiveMarketData TLS handshake failed: " << ec.message() << '\n';
+            fail("TLS handshake", ec);
             return;
         }
         beast::get_lowest_layer(ws_).expires_never();
-        ws_.set_option(ws::stream_base::timeout::suggested(beast::role_type::client));
+        auto timeout = ws::stream_base::timeout::suggested(beast::role_type::client);
+        timeout.idle_timeout = staleAfter_;
+        timeout.keep_alive_pings = true;
+        ws_.set_option(timeout);
+        ws_.control_callback([this](ws::frame_type, beast::string_view) {
+            lastActivity_ = std::chrono::steady_clock::now();
+        });
         ws_.async_handshake(host_, target_,
                             beast::bind_front_handler(&Session::onWsHandshake, shared_from_this()));
     }
 
-    void onWsHandshake(beast::error_code ec) {
-        if (ec) {
-            std::cerr << "BinanceLiveMarketData WS handshake failed: " << ec.message() << '\n';
-            return;
-        }
-        doRead();
-    }
+    void onWsHandshake(beast::error_code ec);
 
     void doRead() {
-        ws_.async_read(buffer_, beast::bind_front_handler(&Session::onRead, shared_from_this()));
+        ws_.async_read(lease_.buffer(), beast::bind_front_handler(&Session::onRead, shared_from_this()));
     }
 
     void onRead(beast::error_code ec, std::size_t) {
         if (ec) {
-            if (ec == asio::error::operation_aborted || ec == ws::error::closed ||
-                ec == beast::errc::not_connected || ec == asio::error::eof) {
-                return;
-            }
-            std::cerr << "BinanceLiveMarketData read failed: " << ec.message() << '\n';
+            fail("read", ec);
             return;
         }
-        if (!callbacksSuppressed_.load() && onText_) {
+        lastActivity_ = std::chrono::steady_clock::now();
+        // Hand the filled buffer over as-is and read the next message into a
+        // fresh one; frames come back to the pool once consumers drop them.
+        FrameRef frame = lease_.publish();
+        lease_ = frames_->acquire();
+        if (!callbacksSuppressed_.load() && onFrame_) {
             try {
-                onText_(beast::buffers_to_string(buffer_.data()));
+                onFrame_(std::move(frame));
             } catch (const std::exception& e) {
-                std::cerr << "BinanceLiveMarketData onText callback failed: " << e.what() << '\n';
+                std::cerr << "BinanceLiveMarketData onFrame callback failed: " << e.what() << '\n';
             } catch (...) {
-                std::cerr << "BinanceLiveMarketData onText callback failed: unknown exception\n";
+                std::cerr << "BinanceLiveMarketData onFrame callback failed: unknown exception\n";
             }
         }
-        buffer_.consume(buffer_.size());
         doRead();
     }
 
-    asio::strand<asio::io_context::executor_type> strand_;
+    Strand strand_;
     tcp::resolver resolver_;
     ws::stream<beast::ssl_stream<beast::tcp_stream>> ws_;
-    beast::flat_buffer buffer_;
     std::string host_;
+    std::string address_;
     std::string port_;
     std::string target_;
-    OnText onText_;
+    OnFrame onFrame_;
+    const std::chrono::milliseconds staleAfter_;
+    const std::weak_ptr<Supervisor> supervisor_;
+    std::shared_ptr<FrameBufferPool> frames_;
+    FrameLease lease_;
+    std::chrono::steady_clock::time_point lastActivity_{};
     std::atomic<bool> callbacksSuppressed_{false};
 };
 
+// Owns the current session and replaces it whenever it fails or goes
+// quiet. Sessions and both timers share the supervisor's strand.
+struct BinanceLiveMarketData::Supervisor : public std::enable_shared_from_this<Supervisor> {
+    Supervisor(asio::io_context& io, ssl::context& tls, std::string host, std::string address,
+               std::string port, std::string target, OnFrame onFrame, OnLinkState onLinkState,
+               ReconnectPolicy policy, std::shared_ptr<SharedStats> stats)
+        : strand_(asio::make_strand(io)),
+          tls_(tls),
+          host_(std::move(host)),
+          address_(std::move(address)),
+          port_(std::move(port)),
+          target_(std::move(target)),
+          onFrame_(std::move(onFrame)),
+          onLinkState_(std::move(onLinkState)),
+          policy_(policy),
+          stats_(std::move(stats)),
+          backoffTimer_(strand_),
+          watchdog_(strand_),
+          random_(std::random_device{}()) {
+    }
+
+    void startAsync() {
+        asio::post(strand_, [self = shared_from_this()]() {
+            self->connect();
+            self->armWatchdog();
+        });
+    }
+
+    void stopAsync() {
+        asio::post(strand_, [self = shared_from_this()]() {
+            self->stopped_ = true;
+            self->backoffTimer_.cancel();
+            self->watchdog_.cancel();
+            if (self->session_) {
+                self->session_->closeAsync();
+                self->session_.reset();
+            }
+        });
+    }
+
+    void onSessionUp(const Session* session) {
+        if (stopped_ || session != session_.get()) {
+            return;
+        }
+        up_ = true;
+        attempt_ = 0;
+        updateStats([this](LinkStats& stats) {
+            ++stats.connects;
+            if (!downSince_) {
+                return;
+            }
+            const auto recovery = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - *downSince_);
+            stats.lastRecoveryMs = static_cast<uint64_t>(recovery.count());
+            stats.maxRecoveryMs = std::max(stats.maxRecoveryMs, stats.lastRecoveryMs);
+            stats.totalRecoveryMs += stats.lastRecoveryMs;
+            ++stats.recoveries;
+        });
+        downSince_.reset();
+        notify(LinkState::Up);
+    }
+
+    void onSessionDown(const Session* session) {
+        if (stopped_ || session != session_.get()) {
+            return;
+        }
+        session_->closeAsync();
+        session_.reset();
+        if (up_) {
+            up_ = false;
+            downSince_ = std::chrono::steady_clock::now();
+            updateStats([](LinkStats& stats) { ++stats.disconnects; });
+            notify(LinkState::Down);
+        }
+        scheduleReconnect();
+    }
+
+  private:
+    void connect() {
+        if (stopped_) {
+            return;
+        }
+        session_ = std::make_shared<Session>(strand_, tls_, host_, address_, port_, target_,
+                                             onFrame_, policy_.staleAfter, weak_from_this());
+        session_->startAsync();
+    }
+
+    // Full jitter over the upper half of the doubled delay keeps a fleet of
+    // clients from redialling in lockstep.
+    void scheduleReconnect() {
+        const auto ceiling = std::min<std::chrono::milliseconds>(
+            policy_.maxBackoff, policy_.initialBackoff * (1LL << std::min(attempt_, 16)));
+        ++attempt_;
+        std::uniform_int_distribution<int64_t> jitter(ceiling.count() / 2, ceiling.count());
+        backoffTimer_.expires_after(std::chrono::milliseconds(jitter(random_)));
+        backoffTimer_.async_wait([self = shared_from_this()](const beast::error_code& ec) {
+            if (!ec) {
+                self->connect();
+            }
+        });
+    }
+
+    void armWatchdog() {
+        watchdog_.expires_after(policy_.staleAfter / 4);
+        watchdog_.async_wait([self = shared_from_this()](const beast::error_code& ec) {
+            if (ec || self->stopped_) {
+                return;
+            }
+            if (self->up_ && self->session_ &&
+                std::chrono::steady_clock::now() - self->session_->lastActivity() >
+                    self->policy_.staleAfter) {
+                std::cerr << "BinanceLiveMarketData stream stale, reconnecting\n";
+                self->updateStats([](LinkStats& stats) { ++stats.watchdogTrips; });
+                self->onSessionDown(self->session_.get());
+            }
+            self->armWatchdog();
+        });
+    }
+
+    void notify(LinkState state) {
+        if (onLinkState_) {
+            onLinkState_(state);
+        }
+    }
+
+    template <typename Update> void updateStats(Update update) {
+        std::lock_guard<std::mutex> lock(stats_->mutex);
+        update(stats_->stats);
+    }
+
+    asio::strand<asio::io_context::executor_type> strand_;
+    ssl::context& tls_;
+    const std::string host_;
+    const std::string address_;
+    const std::string port_;
+    const std::string target_;
+    const OnFrame onFrame_;
+    const OnLinkState onLinkState_;
+    const ReconnectPolicy policy_;
+    const std::shared_ptr<SharedStats> stats_;
+    asio::steady_timer backoffTimer_;
+    asio::steady_timer watchdog_;
+    std::minstd_rand random_;
+    std::shared_ptr<Session> session_;
+    bool up_ = false;
+    bool stopped_ = false;
+    int attempt_ = 0;
+    std::optional<std::chrono::steady_clock::time_point> downSince_;
+};
+
+// Errors after closeAsync() are the close itself and are not reported.
+void BinanceLiveMarketData::Session::fail(std::string_view what, beast::error_code ec) {
+    if (callbacksSuppressed_.load()) {
+        return;
+    }
+    std::cerr << "BinanceLiveMarketData " << what << " failed: " << ec.message() << '\n';
+    if (const auto supervisor = supervisor_.lock()) {
+        supervisor->onSessionDown(this);
+    }
+}
+
+void BinanceLiveMarketData::Session::onWsHandshake(beast::error_code ec) {
+    if (ec) {
+        fail("WS handshake", ec);
+        return;
+    }
+    lastActivity_ = std::chrono::steady_clock::now();
+    if (const auto supervisor = supervisor_.lock()) {
+        supervisor->onSessionUp(this);
+    }
+    doRead();
+}
+
+BinanceLiveMarketData::LinkStats&
+BinanceLiveMarketData::LinkStats::operator+=(const LinkStats& other) {
+    connects += other.connects;
+    disconnects += other.disconnects;
+    watchdogTrips += other.watchdogTrips;
+    recoveries += other.recoveries;
+    lastRecoveryMs = std::max(lastRecoveryMs, other.lastRecoveryMs);
+    maxRecoveryMs = std::max(maxRecoveryMs, other.maxRecoveryMs);
+    totalRecoveryMs += other.totalRecoveryMs;
+    return *this;
+}
+
 BinanceLiveMarketData::~BinanceLiveMarketData() {
     stop();
 }
 
 void BinanceLiveMarketData::start(std::string_view symbol, OnText onText) {
+    startFrames(symbol, [onText = std::move(onText)](FrameRef frame) {
+        onText(std::string(frame.text()));
+    });
+}
+
+void BinanceLiveMarketData::startFrames(std::string_view symbol, OnFrame onFrame) {
+    startTarget(std::format("/ws/{}", streamName(symbol)), std::move(onFrame));
+}
+
+void BinanceLiveMarketData::startStreams(const std::vector<std::string>& symbols,
+                                         OnFrame onFrame) {
+    std::string target = "/stream?streams=";
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        if (i != 0) {
+            target += '/';
+        }
+        target += streamName(symbols[i]);
+    }
+    startTarget(std::move(target), std::move(onFrame));
+}
+
+void BinanceLiveMarketData::startTarget(std::string target, OnFrame onFrame) {
     stop();
 
     try {
@@ -172,41 +406,79 @@ void BinanceLiveMarketData::start(std::string_view symbol, OnText onText) {
         return;
     }
 
-    auto session = std::make_shared<Session>(ioContext_, sslContext_, host_, port_,
-                                             getTarget(symbol), std::move(onText));
-
+    std::shared_ptr<Supervisor> supervisor;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        session_ = session;
+        supervisor = std::make_shared<Supervisor>(ioContext_, sslContext_, host_, address_, port_,
+                                                  std::move(target), std::move(onFrame),
+                                                  onLinkState_, policy_, stats_);
+        supervisor_ = supervisor;
     }
 
-    session->startAsync();
+    supervisor->startAsync();
 }
 
 void BinanceLiveMarketData::stop() {
-    std::shared_ptr<Session> session;
+    std::shared_ptr<Supervisor> supervisor;
 
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        session = session_;
-        session_.reset();
+        supervisor = std::move(supervisor_);
+        supervisor_.reset();
     }
 
-    if (session) {
-        session->closeAsync();
+    if (supervisor) {
+        supervisor->stopAsync();
     }
 }
 
+void BinanceLiveMarketData::setOnLinkState(OnLinkState onLinkState) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onLinkState_ = std::move(onLinkState);
+}
+
+void BinanceLiveMarketData::setReconnectPolicy(ReconnectPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy_ = policy;
+}
+
+BinanceLiveMarketData::LinkStats BinanceLiveMarketData::linkStats() const {
+    std::lock_guard<std::mutex> lock(stats_->mutex);
+    return stats_->stats;
+}
+
+std::vector<std::string> BinanceLiveMarketData::resolveAddresses(asio::io_context& ioContext,
+                                                                 const BinanceHosts& hosts) {
+    std::vector<std::string> addresses;
+    tcp::resolver resolver(ioContext);
+    beast::error_code ec;
+    const auto results = resolver.resolve(hosts.stream, hosts.streamPort, ec);
+    if (ec) {
+        std::cerr << "BinanceLiveMarketData resolve failed: " << ec.message() << '\n';
+        return addresses;
+    }
+    for (const auto& entry : results) {
+        std::string address = entry.endpoint().address().to_string();
+        if (std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+            addresses.push_back(std::move(address));
+        }
+    }
+    return addresses;
+}
+
 void BinanceLiveMarketData::ensureTlsContextConfigured() {
     std::call_once(tlsContextInitOnce_, [this]() {
         sslContext_.set_default_verify_paths();
         sslContext_.set_verify_mode(ssl::verify_peer);
+        if (!caFile_.empty()) {
+            sslContext_.load_verify_file(caFile_);
+        }
     });
 }
 
-std::string BinanceLiveMarketData::getTarget(std::string_view symbol) const {
+std::string BinanceLiveMarketData::streamName(std::string_view symbol) const {
     std::string loweredSymbol(symbol);
     std::transform(symbol.begin(), symbol.end(), loweredSymbol.begin(),
                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return std::format("/ws/{}@depth@{}", loweredSymbol, updateSpeedMs_);
+    return std::format("{}@depth@{}", loweredSymbol, updateSpeedMs_);
 }
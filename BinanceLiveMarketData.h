@@ -1,35 +1,98 @@
 #pragma once
 
+#include "BinanceHosts.h"
 #include "ILiveMarketData.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ssl/context.hpp>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
+// A supervised WebSocket stream. Failed connects, dropped connections and
+// streams silent for longer than `staleAfter` are redialled after a
+// jittered exponential backoff; LinkState reports the outage and the
+// recovery so consumers can resync the moment the new stream is up.
 class BinanceLiveMarketData : public ILiveMarketData {
   public:
+    struct ReconnectPolicy {
+        std::chrono::milliseconds initialBackoff{100};
+        std::chrono::milliseconds maxBackoff{10000};
+        // Longest tolerated silence, counting WebSocket pongs; idle streams
+        // are pinged well before it.
+        std::chrono::milliseconds staleAfter{10000};
+    };
+
+    struct LinkStats {
+        uint64_t connects = 0;
+        uint64_t disconnects = 0;
+        uint64_t watchdogTrips = 0;
+        // Time from losing a live stream to the next one being up.
+        uint64_t recoveries = 0;
+        uint64_t lastRecoveryMs = 0;
+        uint64_t maxRecoveryMs = 0;
+        uint64_t totalRecoveryMs = 0;
+
+        LinkStats& operator+=(const LinkStats& other);
+    };
+
     void start(std::string_view symbol, OnText onText) override final;
+    void startFrames(std::string_view symbol, OnFrame onFrame) override final;
+    // One connection to the combined `/stream?streams=...` endpoint; every
+    // frame is wrapped as `{"stream":"<name>","data":{...}}`.
+    void startStreams(const std::vector<std::string>& symbols, OnFrame onFrame);
     void stop() override final;
-    explicit BinanceLiveMarketData(boost::asio::io_context& ioContext, uint64_t updateSpeedMs = 100)
-        : ioContext_(ioContext),
+    void setOnLinkState(OnLinkState onLinkState) override final;
+    // Takes effect from the next start.
+    void setReconnectPolicy(ReconnectPolicy policy);
+    LinkStats linkStats() const;
+
+    // `address` pins the connection to one resolved IP of the stream host.
+    explicit BinanceLiveMarketData(boost::asio::io_context& ioContext, uint64_t updateSpeedMs = 100,
+                                   std::string address = {}, BinanceHosts hosts = {})
+        : host_(std::move(hosts.stream)),
+          port_(std::move(hosts.streamPort)),
+          caFile_(std::move(hosts.caFile)),
+          ioContext_(ioContext),
           sslContext_(boost::asio::ssl::context::tls_client),
-          updateSpeedMs_(updateSpeedMs == 1000 ? "1000ms" : "100ms") {
+          updateSpeedMs_(updateSpeedMs == 1000 ? "1000ms" : "100ms"),
+          address_(std::move(address)),
+          stats_(std::make_shared<SharedStats>()) {
     }
     ~BinanceLiveMarketData() override;
 
+    // Distinct addresses the stream host resolves to right now; blocking.
+    static std::vector<std::string> resolveAddresses(boost::asio::io_context& ioContext,
+                                                     const BinanceHosts& hosts = {});
+
   private:
     struct Session;
+    struct Supervisor;
+    // Outlives restarts and any supervisor still winding down.
+    struct SharedStats {
+        std::mutex mutex;
+        LinkStats stats;
+    };
+
     void ensureTlsContextConfigured();
-    std::string getTarget(std::string_view symbol) const;
+    void startTarget(std::string target, OnFrame onFrame);
+    std::string streamName(std::string_view symbol) const;
 
-    const std::string host_ = "fstream.binance.com";
-    const std::string port_ = "443";
+    const std::string host_;
+    const std::string port_;
+    const std::string caFile_;
     boost::asio::io_context& ioContext_;
     boost::asio::ssl::context sslContext_;
     const std::string updateSpeedMs_;
-    std::mutex mutex_;
+    const std::string address_;
+    mutable std::mutex mutex_;
     std::once_flag tlsContextInitOnce_;
-    std::shared_ptr<Session> session_;
+    std::shared_ptr<Supervisor> supervisor_;
+    OnLinkState onLinkState_;
+    ReconnectPolicy policy_;
+    const std::shared_ptr<SharedStats> stats_;
 };
@@ -1,57 +1,59 @@
 #include "BinanceOrderBookSync.h"
 
 #include <boost/asio/post.hpp>
-#include <boost/json.hpp>
-#include <charconv>
-#include <iterator>
+#include <algorithm>
 #include <limits>
 #include <optional>
 #include <utility>
 
 namespace {
-std::optional<uint64_t> parseU64(const boost::json::value& value) {
-    if (value.is_uint64()) {
-        return value.as_uint64();
-    }
-    if (value.is_int64()) {
-        const auto n = value.as_int64();
-        if (n < 0) {
-            return std::nullopt;
-        }
-        return static_cast<uint64_t>(n);
-    }
-    if (!value.is_string()) {
-        return std::nullopt;
-    }
-
-    uint64_t out = 0;
-    const auto s = value.as_string();
-    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
-    if (ec != std::errc() || ptr != s.data() + s.size()) {
-        return std::nullopt;
-    }
-    return out;
-}
+// Frames held while scales are unknown; the oldest are dropped beyond this,
+// which only moves the bootstrap bridge point forward.
+constexpr std::size_t kMaxPendingFrames = 4096;
+// Small enough that applying the first batch overlaps decoding the rest.
+constexpr std::size_t kReplayBatchEvents = 64;
+// Book updates between refreshes of SyncStats::latency.
+constexpr uint32_t kLatencyRefreshUpdates = 256;
 
 uint64_t nextUpdateId(uint64_t localUpdate) {
     return (localUpdate == std::numeric_limits<uint64_t>::max()) ? std::numeric_limits<uint64_t>::max()
                                                                   : localUpdate + 1;
 }
 
-bool bridgesExpected(const OrderBookDelta& delta, uint64_t expectedUpdate) {
-    return delta.firstUpdate <= expectedUpdate && expectedUpdate <= delta.lastUpdate;
+bool bridgesExpected(uint64_t firstUpdate, uint64_t lastUpdate, uint64_t expectedUpdate) {
+    return firstUpdate <= expectedUpdate && expectedUpdate <= lastUpdate;
+}
+
+// Whether an event may be applied to a book current as of `localUpdate`:
+// by its `pu` when the stream sends one, else by where its range starts.
+bool continuesBook(uint64_t firstUpdate, uint64_t lastUpdate,
+                   std::optional<uint64_t> previousLastUpdate, uint64_t localUpdate) {
+    const uint64_t expectedNext = nextUpdateId(localUpdate);
+    if (previousLastUpdate.has_value() && *previousLastUpdate != 0) {
+        return *previousLastUpdate == localUpdate ||
+               bridgesExpected(firstUpdate, lastUpdate, expectedNext);
+    }
+    return firstUpdate <= expectedNext;
+}
+
+std::vector<std::optional<BinanceAPIParser::DepthUpdate>> decodeEvents(
+    const BinanceAPIParser& parser, const std::vector<std::string_view>& raw) {
+    std::vector<std::optional<BinanceAPIParser::DepthUpdate>> events;
+    events.reserve(raw.size());
+    for (const auto text : raw) {
+        events.push_back(parser.parseDepthUpdate(text));
+    }
+    return events;
 }
 } // namespace
 
 void BinanceOrderBookSync::onDelta(const OrderBookDelta& delta) {
     boost::asio::post(strand_, [this, delta]() {
-        const BufferedEvent meta{
-            .raw = {},
-            .firstUpdate = delta.firstUpdate,
-            .lastUpdate = delta.lastUpdate,
+        const BufferedEvent event{
+            .delta = delta,
             .previousLastUpdate = std::nullopt,
         };
-        (void)applyDeltaChecked(delta, meta);
+        (void)applyDeltaChecked(event);
     });
 }
 
@@ -67,6 +69,13 @@ void BinanceOrderBookSync::stop() {
     boost::asio::post(strand_, [this]() { stopImpl(); });
 }
 
+void BinanceOrderBookSync::stop(std::function<void()> onStopped) {
+    boost::asio::post(strand_, [this, onStopped = std::move(onStopped)]() {
+        stopImpl();
+        onStopped();
+    });
+}
+
 void BinanceOrderBookSync::setOnBookUpdated(OnBookUpdated onBookUpdated) {
     boost::asio::post(strand_,
                       [this, onBookUpdated = std::move(onBookUpdated)]() mutable {
@@ -74,19 +83,105 @@ void BinanceOrderBookSync::setOnBookUpdated(OnBookUpdated onBookUpdated) {
                       });
 }
 
+void BinanceOrderBookSync::setOnLevelsChanged(OnLevelsChanged onLevelsChanged) {
+    boost::asio::post(strand_,
+                      [this, onLevelsChanged = std::move(onLevelsChanged)]() mutable {
+                          onLevelsChanged_ = std::move(onLevelsChanged);
+                      });
+}
+
+void BinanceOrderBookSync::setResyncMode(ResyncMode mode) {
+    boost::asio::post(strand_, [this, mode]() { resyncMode_ = mode; });
+}
+
+void BinanceOrderBookSync::setBootstrapBufferLimit(std::size_t maxBytes) {
+    boost::asio::post(strand_, [this, maxBytes]() {
+        bootstrapBufferOptions_.maxBytes = maxBytes;
+        bootstrapEvents_->setMaxBytes(maxBytes);
+    });
+}
+
+void BinanceOrderBookSync::setDecodeExecutor(boost::asio::any_io_executor executor) {
+    boost::asio::post(strand_, [this, executor = std::move(executor)]() mutable {
+        decodeExecutor_ = std::move(executor);
+    });
+}
+
+void BinanceOrderBookSync::setCheckpointWriter(std::shared_ptr<BookCheckpointWriter> writer,
+                                              std::chrono::milliseconds interval) {
+    boost::asio::post(strand_, [this, writer = std::move(writer), interval]() mutable {
+        checkpointWriter_ = std::move(writer);
+        checkpointInterval_ = interval;
+        if (state_ != State::Stopped) {
+            scheduleCheckpoint();
+        }
+    });
+}
+
+void BinanceOrderBookSync::setWarmStart(BookCheckpoint checkpoint) {
+    boost::asio::post(strand_, [this, checkpoint = std::move(checkpoint)]() mutable {
+        warmStart_ = std::move(checkpoint);
+    });
+}
+
+void BinanceOrderBookSync::setExchangeClock(std::shared_ptr<const ExchangeClock> clock) {
+    boost::asio::post(strand_, [this, clock = std::move(clock)]() mutable {
+        exchangeClock_ = std::move(clock);
+    });
+}
+
+void BinanceOrderBookSync::updateScales(SymbolScales scales) {
+    boost::asio::post(strand_, [this, scales]() {
+        if (hasScales_ && scales == scales_) {
+            return;
+        }
+        const bool first = !hasScales_;
+        scales_ = scales;
+        hasScales_ = true;
+        stats_.hasScales = true;
+        parser_ = BinanceAPIParser(scales);
+        book_ = OrderBook(scales.priceTick, poolOptions_);
+        if (!first) {
+            restartBootstrap();
+            return;
+        }
+        if (state_ == State::Bootstrapping) {
+            replayPendingFrames();
+            requestSnapshot(generation_);
+        }
+    });
+}
+
 const OrderBook& BinanceOrderBookSync::orderBook() const {
     return book_;
 }
 
+const BinanceOrderBookSync::SyncStats& BinanceOrderBookSync::syncStats() const {
+    return stats_;
+}
+
 void BinanceOrderBookSync::startImpl(std::string symbol) {
     ++generation_;
+    ++feedEpoch_;
     symbol_ = std::move(symbol);
     stats_ = SyncStats{};
-    beginBootstrapCycle();
+    latency_ = LatencyHistograms{};
+    updatesSinceLatency_ = 0;
+    startedAt_ = std::chrono::steady_clock::now();
+    linkDown_ = false;
+    checkpointedUpdate_ = 0;
+    beginBootstrapCycle(false);
+    liveMarketData_.stop();
+    startLiveFeed(feedEpoch_, symbol_);
+    scheduleCheckpoint();
 }
 
 void BinanceOrderBookSync::stopImpl() {
+    writeCheckpoint();
+    checkpointTimer_.cancel();
+    warmStart_.reset();
     ++generation_;
+    ++feedEpoch_;
     state_ = State::Stopped;
     snapshotInFlight_ = false;
     resetBootstrapBuffer();
@@ -101,34 +196,96 @@ void BinanceOrderBookSync::restartBootstrap() {
 
     ++generation_;
     ++stats_.resyncs;
-    beginBootstrapCycle();
+    warmStart_.reset();
+    // A book on a new price grid starts empty and has nothing to keep.
+    beginBootstrapCycle(resyncMode_ == ResyncMode::KeepStale && book_.getLastUpdate() != 0);
 }
 
 void BinanceOrderBookSync::resetBootstrapBuffer() {
-    bufferedEvents_.clear();
+    replay_ = Replay{};
+    resetBootstrapArena();
+    stats_.bootstrapBufferBytes = bootstrapEvents_->reservedBytes();
     hasFirstBufferedEvent_ = false;
     firstBufferedUpdateId_ = 0;
+    pendingFrames_.clear();
 }
 
-void BinanceOrderBookSync::beginBootstrapCycle() {
+void BinanceOrderBookSync::beginBootstrapCycle(bool keepBook) {
     state_ = State::Bootstrapping;
+    bootstrapStartedAt_ = std::chrono::steady_clock::now();
     snapshotInFlight_ = false;
     resetBootstrapBuffer();
-    applySnapshotImpl(OrderBookSnapshot{});
-    liveMarketData_.stop();
-    startLiveFeed(generation_, symbol_);
+    if (keepBook) {
+        stats_.stale = true;
+        notifyBookUpdated();
+    } else {
+        stats_.stale = false;
+        applySnapshotImpl(OrderBookSnapshot{});
+    }
     requestSnapshot(generation_);
 }
 
-void BinanceOrderBookSync::startLiveFeed(uint64_t generation, std::string symbol) {
-    liveMarketData_.start(symbol, [this, generation](std::string msg) {
-        boost::asio::post(strand_, [this, generation, msg = std::move(msg)]() mutable {
-            onRawText(generation, std::move(msg));
+// The stream stays up across resyncs: frames already queued from before a
+// restart are just early bootstrap events, which the bridge check handles.
+void BinanceOrderBookSync::startLiveFeed(uint64_t epoch, std::string symbol) {
+    liveMarketData_.setOnLinkState([this, epoch](ILiveMarketData::LinkState state) {
+        boost::asio::post(strand_, [this, epoch, state]() { onLinkState(epoch, state); });
+    });
+    liveMarketData_.startFrames(symbol, [this, epoch](FrameRef frame) {
+        boost::asio::post(strand_, [this, epoch, frame = std::move(frame)]() mutable {
+            onFrame(epoch, std::move(frame));
         });
     });
 }
 
-void BinanceOrderBookSync::onRawText(uint64_t generation, std::string msg) {
+void BinanceOrderBookSync::onFrame(uint64_t epoch, FrameRef frame) {
+    if (epoch != feedEpoch_ || state_ == State::Stopped) {
+        return;
+    }
+    if (hasScales_) {
+        frameReceivedAt_ = frame.receivedAt();
+        stageMark_ = frameReceivedAt_;
+        markStage(latency_.dispatch);
+        onRawText(generation_, frame.text(), frame.receivedAt());
+        frameReceivedAt_ = {};
+        return;
+    }
+    if (pendingFrames_.size() == kMaxPendingFrames) {
+        ++stats_.wsMessages;
+        ++stats_.droppedDeltas;
+        pendingFrames_.pop_front();
+    }
+    pendingFrames_.push_back(std::move(frame));
+}
+
+// Down freezes the book and flags it stale; the first Up after it resyncs
+// at once instead of waiting for the next delta to expose the gap.
+void BinanceOrderBookSync::onLinkState(uint64_t epoch, ILiveMarketData::LinkState state) {
+    if (epoch != feedEpoch_ || state_ == State::Stopped) {
+        return;
+    }
+    if (state == ILiveMarketData::LinkState::Down) {
+        linkDown_ = true;
+        ++stats_.linkDowns;
+        stats_.stale = book_.getLastUpdate() != 0;
+        notifyBookUpdated();
+        return;
+    }
+    if (std::exchange(linkDown_, false)) {
+        restartBootstrap();
+    }
+}
+
+void BinanceOrderBookSync::replayPendingFrames() {
+    auto frames = std::move(pendingFrames_);
+    pendingFrames_.clear();
+    for (const auto& frame : frames) {
+        onRawText(generation_, frame.text(), frame.receivedAt());
+    }
+}
+
+void BinanceOrderBookSync::onRawText(uint64_t generation, std::string_view msg,
+                                     std::chrono::steady_clock::time_point receivedAt) {
     if (generation != generation_ || state_ == State::Stopped) {
         return;
     }
@@ -136,42 +293,86 @@ void BinanceOrderBookSync::onRawText(uint64_t generation, std::string msg) {
     ++stats_.wsMessages;
 
     if (state_ == State::Bootstrapping) {
-        auto buffered = parseBufferedEvent(std::move(msg));
-        if (!buffered) {
-            ++stats_.droppedDeltas;
-            return;
-        }
-
-        if (!hasFirstBufferedEvent_) {
-            hasFirstBufferedEvent_ = true;
-            firstBufferedUpdateId_ = buffered->firstUpdate;
-        }
+        // Held frames are timed from replay, if at all.
+        frameReceivedAt_ = {};
+        bufferBootstrapEvent(msg, receivedAt);
+        return;
+    }
 
-        bufferedEvents_.push_back(std::move(*buffered));
-        if (!snapshotInFlight_) {
-            requestSnapshot(generation_);
-        }
+    auto event = parser_.parseDepthUpdate(msg);
+    markStage(latency_.decode);
+    if (!event) {
+        ++stats_.droppedDeltas;
         return;
     }
+    event->delta.receivedAt = receivedAt;
+    (void)applyDeltaChecked(*event);
+}
 
-    auto meta = parseBufferedEvent(std::move(msg));
-    if (!meta) {
+// Only the sequence fields are decoded now; the levels are parsed from the
+// arena once the snapshot has said which events still matter.
+void BinanceOrderBookSync::bufferBootstrapEvent(std::string_view msg,
+                                                std::chrono::steady_clock::time_point receivedAt) {
+    const auto ids = parser_.parseUpdateIds(msg);
+    if (!ids) {
         ++stats_.droppedDeltas;
         return;
     }
 
-    const auto delta = parser_.parseDelta(meta->raw);
-    (void)applyDeltaChecked(delta, *meta);
+    const BootstrapArena::Event event{
+        .firstUpdate = ids->firstUpdate,
+        .lastUpdate = ids->lastUpdate,
+        .previousLastUpdate = ids->previousLastUpdate,
+        .raw = msg,
+        .receivedAt = receivedAt,
+    };
+    if (!bootstrapEvents_->append(event)) {
+        ++stats_.bootstrapOverflows;
+        if (replay_.active) {
+            // Events past the replayed ones are lost, so the book cannot
+            // catch up from here.
+            ++stats_.droppedDeltas;
+            restartBootstrap();
+            return;
+        }
+        stats_.droppedDeltas += bootstrapEvents_->size();
+        resetBootstrapArena();
+        hasFirstBufferedEvent_ = false;
+        if (!bootstrapEvents_->append(event)) {
+            ++stats_.droppedDeltas;
+            return;
+        }
+    }
+    stats_.bootstrapBufferBytes = bootstrapEvents_->reservedBytes();
+
+    if (!hasFirstBufferedEvent_) {
+        hasFirstBufferedEvent_ = true;
+        firstBufferedUpdateId_ = ids->firstUpdate;
+    }
+    if (!snapshotInFlight_) {
+        requestSnapshot(generation_);
+    }
 }
 
 void BinanceOrderBookSync::requestSnapshot(uint64_t generation) {
-    if (snapshotInFlight_ || state_ != State::Bootstrapping) {
+    if (snapshotInFlight_ || state_ != State::Bootstrapping || !hasScales_ || replay_.active) {
+        return;
+    }
+    if (warmStart_) {
+        tryWarmStart();
         return;
     }
 
     snapshotInFlight_ = true;
-    snapshotSource_.getSnapshotAsync([this, generation](std::optional<OrderBookSnapshot> snapshot) {
-        boost::asio::post(strand_, [this, generation, snapshot = std::move(snapshot)]() mutable {
+    const auto requestedAt = std::chrono::steady_clock::now();
+    snapshotSource_.getSnapshotAsync([this, generation,
+                                      requestedAt](std::optional<OrderBookSnapshot> snapshot) {
+        const auto roundTrip = std::chrono::steady_clock::now() - requestedAt;
+        boost::asio::post(strand_, [this, generation, roundTrip,
+                                    snapshot = std::move(snapshot)]() mutable {
+            if (snapshot) {
+                latency_.snapshotRtt.record(roundTrip);
+            }
             onSnapshotReady(generation, std::move(snapshot));
         });
     });
@@ -205,50 +406,228 @@ void BinanceOrderBookSync::onSnapshotReady(uint64_t generation,
         return;
     }
 
-    while (!bufferedEvents_.empty() && bufferedEvents_.front().lastUpdate <= book_.getLastUpdate()) {
+    const BootstrapArena& events = *bootstrapEvents_;
+    std::size_t next = 0;
+    while (next < events.size() && events[next].lastUpdate <= book_.getLastUpdate()) {
         ++stats_.droppedDeltas;
-        bufferedEvents_.pop_front();
+        ++next;
     }
 
-    if (!bufferedEvents_.empty()) {
-        const auto& first = bufferedEvents_.front();
-        const uint64_t localUpdate = book_.getLastUpdate();
-        const uint64_t expectedNext = nextUpdateId(localUpdate);
-        if (!(first.firstUpdate <= expectedNext && expectedNext <= first.lastUpdate)) {
+    if (next < events.size()) {
+        const auto first = events[next];
+        if (!bridgesExpected(first.firstUpdate, first.lastUpdate,
+                             nextUpdateId(book_.getLastUpdate()))) {
             restartBootstrap();
             return;
         }
     }
 
-    if (!bufferedEvents_.empty()) {
-        BufferedEvent firstMeta = bufferedEvents_.front();
-        // On Binance futures, `pu` of the first event after snapshot may not
-        // equal snapshot lastUpdateId; bridge is validated via [U, u].
-        firstMeta.previousLastUpdate.reset();
-        const auto firstDelta = parser_.parseDelta(firstMeta.raw);
-        if (!applyDeltaChecked(firstDelta, firstMeta)) {
-            return;
+    startReplay(next, true);
+}
+
+// Waits for the first held event past the checkpoint; the book goes Live
+// from the checkpoint only if that event continues it. Nothing before the
+// decision touches the network.
+void BinanceOrderBookSync::tryWarmStart() {
+    if (warmStart_->symbol != symbol_ || warmStart_->scales != scales_) {
+        warmStart_.reset();
+        requestSnapshot(generation_);
+        return;
+    }
+    const BootstrapArena& events = *bootstrapEvents_;
+    const uint64_t lastUpdate = warmStart_->book.lastUpdate;
+    std::size_t next = 0;
+    while (next < events.size() && events[next].lastUpdate <= lastUpdate) {
+        ++next;
+    }
+    if (next == events.size()) {
+        return;
+    }
+
+    const auto first = events[next];
+    BookCheckpoint checkpoint = std::move(*warmStart_);
+    warmStart_.reset();
+    if (!continuesBook(first.firstUpdate, first.lastUpdate, first.previousLastUpdate,
+                       lastUpdate)) {
+        ++stats_.warmStartMisses;
+        requestSnapshot(generation_);
+        return;
+    }
+    ++stats_.warmStarts;
+    stats_.droppedDeltas += next;
+    applySnapshotImpl(checkpoint.book);
+    startReplay(next, false);
+}
+
+// Workers hand their arena references back on the strand, so the count is
+// exact here.
+void BinanceOrderBookSync::resetBootstrapArena() {
+    if (bootstrapEvents_.use_count() > 1) {
+        bootstrapEvents_ = std::make_shared<BootstrapArena>(bootstrapBufferOptions_);
+        return;
+    }
+    bootstrapEvents_->reset();
+}
+
+// Still Bootstrapping: frames arriving meanwhile are held behind the
+// replayed ones and replayed in turn before the book goes Live.
+void BinanceOrderBookSync::startReplay(std::size_t from, bool bridgeByRange) {
+    replay_ = Replay{};
+    replay_.active = true;
+    replay_.bridge = from;
+    replay_.bridgeByRange = bridgeByRange;
+    replay_.dispatched = from;
+    replayStartedAt_ = std::chrono::steady_clock::now();
+    dispatchReplay();
+}
+
+// Hands every held event not yet dispatched to decoding, in batches.
+// Without an executor each batch is decoded and applied right here.
+void BinanceOrderBookSync::dispatchReplay() {
+    const uint64_t generation = generation_;
+    replay_.dispatching = true;
+    while (generation == generation_ && replay_.active &&
+           replay_.dispatched < bootstrapEvents_->size()) {
+        const std::size_t first = replay_.dispatched;
+        const std::size_t count = std::min(kReplayBatchEvents, bootstrapEvents_->size() - first);
+        std::vector<std::string_view> raw;
+        raw.reserve(count);
+        for (std::size_t i = first; i < first + count; ++i) {
+            raw.push_back((*bootstrapEvents_)[i].raw);
+        }
+        replay_.dispatched += count;
+        const std::size_t batch = replay_.batches.size();
+        replay_.batches.emplace_back();
+
+        if (!decodeExecutor_) {
+            onReplayBatch(generation, batch, ReplayBatch{first, decodeEvents(parser_, raw)});
+            continue;
         }
+        boost::asio::post(decodeExecutor_, [this, generation, batch, first, parser = parser_,
+                                            arena = bootstrapEvents_,
+                                            raw = std::move(raw)]() mutable {
+            ReplayBatch decoded{first, decodeEvents(parser, raw)};
+            boost::asio::post(strand_, [this, generation, batch, arena = std::move(arena),
+                                        decoded = std::move(decoded)]() mutable {
+                arena.reset();
+                onReplayBatch(generation, batch, std::move(decoded));
+            });
+        });
     }
+    if (generation != generation_ || !replay_.active) {
+        return;
+    }
+    replay_.dispatching = false;
+    advanceReplay();
+}
+
+void BinanceOrderBookSync::onReplayBatch(uint64_t generation, std::size_t batch,
+                                         ReplayBatch decoded) {
+    if (generation != generation_ || !replay_.active) {
+        return;
+    }
+    replay_.batches[batch] = std::move(decoded);
+    advanceReplay();
+}
 
-    if (bufferedEvents_.size() > 1) {
-        for (auto it = std::next(bufferedEvents_.begin()); it != bufferedEvents_.end(); ++it) {
-            const auto delta = parser_.parseDelta(it->raw);
-            if (!applyDeltaChecked(delta, *it)) {
+// Applies decoded batches strictly in dispatch order; a batch that is back
+// early waits for the ones before it.
+void BinanceOrderBookSync::advanceReplay() {
+    while (replay_.appliedBatches < replay_.batches.size() &&
+           replay_.batches[replay_.appliedBatches]) {
+        ReplayBatch batch = std::move(*replay_.batches[replay_.appliedBatches]);
+        replay_.batches[replay_.appliedBatches].reset();
+        ++replay_.appliedBatches;
+
+        for (std::size_t i = 0; i < batch.events.size(); ++i) {
+            auto& event = batch.events[i];
+            if (!event) {
+                ++stats_.droppedDeltas;
+                continue;
+            }
+            if (replay_.bridgeByRange && batch.first + i == replay_.bridge) {
+                // On Binance futures, `pu` of the first event after snapshot
+                // may not equal snapshot lastUpdateId; bridge is validated
+                // via [U, u].
+                event->previousLastUpdate.reset();
+            }
+            event->delta.receivedAt = (*bootstrapEvents_)[batch.first + i].receivedAt;
+            if (!applyDeltaChecked(*event)) {
                 return;
             }
         }
     }
 
-    bufferedEvents_.clear();
+    if (replay_.dispatching || replay_.appliedBatches < replay_.batches.size()) {
+        return;
+    }
+    if (replay_.dispatched < bootstrapEvents_->size()) {
+        dispatchReplay();
+        return;
+    }
+    finishBootstrap();
+}
+
+void BinanceOrderBookSync::finishBootstrap() {
+    const auto now = std::chrono::steady_clock::now();
+    stats_.lastReplayUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - replayStartedAt_).count());
+    stats_.lastReplayEvents = replay_.dispatched - replay_.bridge;
+    resetBootstrapBuffer();
     state_ = State::Live;
+    stats_.stale = false;
+    const auto bootstrap =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - bootstrapStartedAt_);
+    stats_.lastBootstrapMs = static_cast<uint64_t>(bootstrap.count());
+    stats_.maxBootstrapMs = std::max(stats_.maxBootstrapMs, stats_.lastBootstrapMs);
+    if (stats_.firstSyncMs != 0) {
+        latency_.resync.record(now - bootstrapStartedAt_);
+    }
+    if (stats_.firstSyncMs == 0) {
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - startedAt_);
+        stats_.firstSyncMs = std::max<uint64_t>(1, static_cast<uint64_t>(elapsed.count()));
+    }
+    publishLatency();
+    notifyBookUpdated();
 }
 
-bool BinanceOrderBookSync::applyDeltaChecked(const OrderBookDelta& delta, const BufferedEvent& meta) {
+void BinanceOrderBookSync::scheduleCheckpoint() {
+    if (!checkpointWriter_ || checkpointInterval_.count() <= 0) {
+        return;
+    }
+    checkpointTimer_.expires_after(checkpointInterval_);
+    checkpointTimer_.async_wait([this, epoch = feedEpoch_](const boost::system::error_code& ec) {
+        if (ec || epoch != feedEpoch_) {
+            return;
+        }
+        writeCheckpoint();
+        scheduleCheckpoint();
+    });
+}
+
+// Only the level copy happens on the strand; encoding and the file write
+// are the writer's.
+void BinanceOrderBookSync::writeCheckpoint() {
+    if (!checkpointWriter_ || state_ != State::Live || stats_.stale ||
+        book_.getLastUpdate() == checkpointedUpdate_) {
+        return;
+    }
+    checkpointBuffer_.symbol = symbol_;
+    checkpointBuffer_.scales = scales_;
+    checkpointBuffer_.book.lastUpdate = book_.getLastUpdate();
+    book_.topBids(std::numeric_limits<std::size_t>::max(), checkpointBuffer_.book.bids);
+    book_.topAsks(std::numeric_limits<std::size_t>::max(), checkpointBuffer_.book.asks);
+    checkpointedUpdate_ = checkpointBuffer_.book.lastUpdate;
+    checkpointBuffer_ = checkpointWriter_->submit(std::move(checkpointBuffer_));
+}
+
+bool BinanceOrderBookSync::applyDeltaChecked(const BufferedEvent& event) {
     if (state_ == State::Stopped) {
         return false;
     }
 
+    const auto& delta = event.delta;
     if (delta.lastUpdate == 0 || delta.firstUpdate == 0) {
         ++stats_.droppedDeltas;
         return true;
@@ -260,13 +639,8 @@ bool BinanceOrderBookSync::applyDeltaChecked(const OrderBookDelta& delta, const
         return true;
     }
 
-    const uint64_t expectedNext = nextUpdateId(localUpdate);
-    const bool hasPrevious = meta.previousLastUpdate.has_value() && *meta.previousLastUpdate != 0;
-    const bool sequential =
-        hasPrevious ? (*meta.previousLastUpdate == localUpdate || bridgesExpected(delta, expectedNext))
-                    : (delta.firstUpdate <= expectedNext);
-
-    if (!sequential) {
+    if (!continuesBook(delta.firstUpdate, delta.lastUpdate, event.previousLastUpdate,
+                       localUpdate)) {
         ++stats_.droppedDeltas;
         restartBootstrap();
         return false;
@@ -274,53 +648,124 @@ bool BinanceOrderBookSync::applyDeltaChecked(const OrderBookDelta& delta, const
 
     book_.applyDelta(delta);
     ++stats_.acceptedDeltas;
+    markStage(latency_.apply);
+    recordFeedLatency(delta);
+    notifyLevelsChanged(delta);
     notifyBookUpdated();
+    if (frameReceivedAt_ != std::chrono::steady_clock::time_point{}) {
+        markStage(latency_.notify);
+        latency_.wire.record(stageMark_ - frameReceivedAt_);
+    }
     return true;
 }
 
+// A stale book, or one with a level consumer, takes the snapshot as a
+// diff so only levels that moved are touched and reported.
 void BinanceOrderBookSync::applySnapshotImpl(const OrderBookSnapshot& snapshot) {
-    book_.applySnapshot(snapshot);
+    if (!stats_.stale && !onLevelsChanged_) {
+        book_.applySnapshot(snapshot);
+        notifyBookUpdated();
+        return;
+    }
+    const OrderBookDelta diff = book_.diffSnapshot(snapshot);
+    book_.applyDelta(diff);
+    if (stats_.stale) {
+        stats_.reconciledLevels = diff.bids.size() + diff.asks.size();
+    }
+    notifyLevelsChanged(diff);
     notifyBookUpdated();
 }
 
+void BinanceOrderBookSync::scalesFetchFailed() {
+    boost::asio::post(strand_, [this]() {
+        if (hasScales_ || state_ == State::Stopped) {
+            return;
+        }
+        ++stats_.scalesFetchFailures;
+        notifyBookUpdated();
+    });
+}
+
+// Held frames would otherwise wait for scales that never come.
+void BinanceOrderBookSync::scalesMissing() {
+    boost::asio::post(strand_, [this]() {
+        if (hasScales_ || state_ == State::Stopped) {
+            return;
+        }
+        stats_.scalesMissing = true;
+        notifyBookUpdated();
+        stopImpl();
+    });
+}
+
 void BinanceOrderBookSync::notifyBookUpdated() {
+    const auto pool = book_.poolStats();
+    stats_.poolHighWater = pool.highWater;
+    stats_.poolSlabs = pool.slabs;
+    if (++updatesSinceLatency_ >= kLatencyRefreshUpdates) {
+        publishLatency();
+    }
+    // Without scales the book is empty; the call carries the scales state.
     if (onBookUpdated_) {
         onBookUpdated_(book_, scales_, stats_);
     }
 }
 
-std::optional<BinanceOrderBookSync::BufferedEvent> BinanceOrderBookSync::parseBufferedEvent(
-    std::string raw) {
-    namespace json = boost::json;
-
-    boost::system::error_code ec;
-    const auto parsed = json::parse(raw, ec);
-    if (ec || !parsed.is_object()) {
-        return std::nullopt;
+void BinanceOrderBookSync::notifyLevelsChanged(const OrderBookDelta& delta) {
+    if (onLevelsChanged_ && hasScales_) {
+        onLevelsChanged_(delta, stats_);
     }
+}
 
-    const auto& obj = parsed.as_object();
-    const auto* firstUpdate = obj.if_contains("U");
-    const auto* lastUpdate = obj.if_contains("u");
-    if (!firstUpdate || !lastUpdate) {
-        return std::nullopt;
+void BinanceOrderBookSync::markStage(LatencyHistogram& histogram) {
+    if (frameReceivedAt_ == std::chrono::steady_clock::time_point{}) {
+        return;
     }
-    const auto* previousLastUpdate = obj.if_contains("pu");
+    const auto now = std::chrono::steady_clock::now();
+    histogram.record(now - stageMark_);
+    stageMark_ = now;
+}
 
-    const auto first = parseU64(*firstUpdate);
-    const auto last = parseU64(*lastUpdate);
-    if (!first || !last || *first == 0 || *last == 0 || *first > *last) {
-        return std::nullopt;
+// Deltas replayed from a bootstrap count too: their lag is what it was
+// when they arrived.
+void BinanceOrderBookSync::recordFeedLatency(const OrderBookDelta& delta) {
+    if (delta.eventTimeMs == 0) {
+        return;
     }
-    std::optional<uint64_t> prev{};
-    if (previousLastUpdate) {
-        prev = parseU64(*previousLastUpdate);
+    const auto now = std::chrono::steady_clock::now();
+    if (delta.transactionTimeMs != 0 && delta.eventTimeMs >= delta.transactionTimeMs) {
+        latency_.exchange.record((delta.eventTimeMs - delta.transactionTimeMs) * 1'000'000, now);
     }
+    if (!exchangeClock_ || delta.receivedAt == std::chrono::steady_clock::time_point{}) {
+        return;
+    }
+    const auto receivedAt = std::chrono::system_clock::now() -
+                            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                now - delta.receivedAt);
+    const auto receivedUs = exchangeClock_->toExchangeUs(receivedAt);
+    if (!receivedUs) {
+        return;
+    }
+    // `E` is truncated to the millisecond, like the server time behind the
+    // offset; both are read at the middle of theirs.
+    const int64_t lagUs = *receivedUs - (static_cast<int64_t>(delta.eventTimeMs) * 1000 + 500);
+    latency_.feed.record(lagUs <= 0 ? 0 : static_cast<uint64_t>(lagUs) * 1000, now);
+}
 
-    return BufferedEvent{
-        .raw = std::move(raw),
-        .firstUpdate = *first,
-        .lastUpdate = *last,
-        .previousLastUpdate = prev,
+void BinanceOrderBookSync::publishLatency() {
+    updatesSinceLatency_ = 0;
+    const auto now = std::chrono::steady_clock::now();
+    stats_.latency = SyncLatency{
+        .dispatch = latency_.dispatch.percentiles(),
+        .decode = latency_.decode.percentiles(),
+        .apply = latency_.apply.percentiles(),
+        .notify = latency_.notify.percentiles(),
+        .wire = latency_.wire.percentiles(),
+        .snapshotRtt = latency_.snapshotRtt.percentiles(),
+        .resync = latency_.resync.percentiles(),
+        .exchange = latency_.exchange.percentiles(now),
+        .feed = latency_.feed.percentiles(now),
+        .clockOffsetUs =
+            exchangeClock_ ? exchangeClock_->offsetUs().value_or(0) : 0,
     };
 }
@@ -1,39 +1,122 @@
 #pragma once
 
 #include "BinanceAPIParser.h"
+#include "BookCheckpoint.h"
+#include "BookCheckpointWriter.h"
+#include "BootstrapArena.h"
+#include "ExchangeClock.h"
 #include "ILiveMarketData.h"
 #include "IOrderBookSync.h"
 #include "ISnapshotSource.h"
+#include "LatencyHistogram.h"
 #include "OrderBook.h"
 
+#include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 class BinanceOrderBookSync : public IOrderBookSync {
   public:
+    // Percentiles since start(), refreshed every few hundred book updates
+    // and on every bootstrap. Live frames are timed stage by stage: socket
+    // read complete, strand dispatch, JSON decode, book apply, and return
+    // from the level and book callbacks.
+    struct SyncLatency {
+        LatencyHistogram::Percentiles dispatch;
+        LatencyHistogram::Percentiles decode;
+        LatencyHistogram::Percentiles apply;
+        // Only calls that have returned, so never the one reading this.
+        LatencyHistogram::Percentiles notify;
+        // Read complete to callback return.
+        LatencyHistogram::Percentiles wire;
+        LatencyHistogram::Percentiles snapshotRtt;
+        LatencyHistogram::Percentiles resync;
+        // Over the last one to two minutes, from each accepted event's
+        // timestamps: `T` to `E` inside the exchange, and `E` to the local
+        // read on the exchange clock, which needs setExchangeClock(). Lag
+        // that the clock estimate puts below zero counts as zero.
+        LatencyHistogram::Percentiles exchange;
+        LatencyHistogram::Percentiles feed;
+        // Exchange clock minus local clock; 0 without an estimate.
+        int64_t clockOffsetUs = 0;
+    };
+
     struct SyncStats {
         uint64_t wsMessages = 0;
         uint64_t acceptedDeltas = 0;
         uint64_t droppedDeltas = 0;
         uint64_t resyncs = 0;
         uint64_t snapshotRetries = 0;
+        uint64_t poolHighWater = 0;
+        uint64_t poolSlabs = 0;
+        // Milliseconds from start() to the first live book; 0 until then.
+        uint64_t firstSyncMs = 0;
+        // Duration of the latest completed bootstrap, initial or resync.
+        uint64_t lastBootstrapMs = 0;
+        uint64_t maxBootstrapMs = 0;
+        // The book is the last good one, frozen while a resync runs.
+        bool stale = false;
+        // Levels the latest stale resync actually changed.
+        uint64_t reconciledLevels = 0;
+        // Stream outages reported by the live feed; each ends in a resync.
+        uint64_t linkDowns = 0;
+        // Times the bootstrap buffer hit its cap and was started over.
+        uint64_t bootstrapOverflows = 0;
+        uint64_t bootstrapBufferBytes = 0;
+        // Decoding and applying the held events once the snapshot landed.
+        uint64_t lastReplayUs = 0;
+        uint64_t lastReplayEvents = 0;
+        // Starts served from a checkpoint, and checkpoints the stream had
+        // already moved past.
+        uint64_t warmStarts = 0;
+        uint64_t warmStartMisses = 0;
+        // False while the sync holds frames waiting for scales; fetches
+        // that failed meanwhile, and whether exchangeInfo does not list the
+        // symbol at all, which stops the sync.
+        bool hasScales = false;
+        uint64_t scalesFetchFailures = 0;
+        bool scalesMissing = false;
+        SyncLatency latency;
+    };
+
+    enum class ResyncMode {
+        // Empty the book on a gap and rebuild it from the next snapshot.
+        Clear,
+        // Keep serving the last good book flagged stale, then diff the
+        // fresh snapshot against it.
+        KeepStale,
     };
 
     using OnBookUpdated = std::function<void(const OrderBook&, const SymbolScales&, const SyncStats&)>;
+    // Every change to the book as levels: deltas as applied, snapshots as
+    // their diff against the previous book. Zero quantity removes a level.
+    using OnLevelsChanged = std::function<void(const OrderBookDelta&, const SyncStats&)>;
 
+    // Without `scales` the sync still connects and subscribes, but holds raw
+    // frames and defers the snapshot until updateScales() supplies them.
     BinanceOrderBookSync(boost::asio::io_context& ioContext, ISnapshotSource& snapshotSource,
-                         ILiveMarketData& liveMarketData, SymbolScales scales)
+                         ILiveMarketData& liveMarketData, std::optional<SymbolScales> scales,
+                         NodePool::Options poolOptions = {})
         : strand_(boost::asio::make_strand(ioContext)),
+          book_(scales ? scales->priceTick : 1, poolOptions),
+          poolOptions_(poolOptions),
           snapshotSource_(snapshotSource),
           liveMarketData_(liveMarketData),
-          scales_(scales),
-          parser_(scales) {
+          scales_(scales.value_or(SymbolScales{})),
+          hasScales_(scales.has_value()),
+          parser_(scales_) {
+        stats_.hasScales = hasScales_;
     }
     BinanceOrderBookSync() = delete;
     BinanceOrderBookSync(const BinanceOrderBookSync&) = delete;
@@ -47,16 +130,80 @@ class BinanceOrderBookSync : public IOrderBookSync {
     void onSnapshot(const OrderBookSnapshot& snapshot) override final;
     void start(std::string_view symbol) override final;
     void stop() override final;
+    // As stop(), then runs `onStopped` on the strand once the final
+    // checkpoint has been handed to the writer.
+    void stop(std::function<void()> onStopped);
 
     void setOnBookUpdated(OnBookUpdated onBookUpdated);
+    void setOnLevelsChanged(OnLevelsChanged onLevelsChanged);
+    void setResyncMode(ResyncMode mode);
+    // Caps the raw frames held while a bootstrap awaits its snapshot. On
+    // overflow the held frames are discarded and buffering starts over from
+    // the next frame; a snapshot older than that is then fetched again.
+    void setBootstrapBufferLimit(std::size_t maxBytes);
+    // Held events are decoded in batches on `executor` while earlier
+    // batches are applied here, in order. Without one they are decoded
+    // inline on the strand.
+    void setDecodeExecutor(boost::asio::any_io_executor executor);
+    // While Live, the book is copied to `writer` every `interval` it has
+    // changed, and once more on stop().
+    void setCheckpointWriter(std::shared_ptr<BookCheckpointWriter> writer,
+                             std::chrono::milliseconds interval);
+    // The next start() holds the stream against `checkpoint` first and goes
+    // Live from it if the first event past it continues it; otherwise, or
+    // if the scales differ, the bootstrap falls back to a snapshot.
+    void setWarmStart(BookCheckpoint checkpoint);
+    // Offsets event times against the local clock for the feed latency in
+    // SyncLatency.
+    void setExchangeClock(std::shared_ptr<const ExchangeClock> clock);
+    // Rebuilds the book on the new price grid and resyncs if `scales`
+    // differs from the current ones. The first scales of a sync built
+    // without them release the held frames instead of resyncing.
+    void updateScales(SymbolScales scales);
+    // Without scales yet: counts a failed scales fetch, or stops the sync
+    // for good because the exchange does not list the symbol. Both show in
+    // SyncStats, which the callback still receives with default scales.
+    void scalesFetchFailed();
+    void scalesMissing();
     const OrderBook& orderBook() const;
+    const SyncStats& syncStats() const;
 
   private:
-    struct BufferedEvent {
-        std::string raw;
-        uint64_t firstUpdate = 0;
-        uint64_t lastUpdate = 0;
-        std::optional<uint64_t> previousLastUpdate;
+    using BufferedEvent = BinanceAPIParser::DepthUpdate;
+
+    struct ReplayBatch {
+        // Arena index of the first event.
+        std::size_t first = 0;
+        std::vector<std::optional<BufferedEvent>> events;
+    };
+
+    struct Replay {
+        bool active = false;
+        bool dispatching = false;
+        // Arena index of the event that bridges the snapshot.
+        std::size_t bridge = 0;
+        // A snapshot need not end on an event boundary, so the event
+        // bridging it is checked by [U, u] alone; a checkpoint does.
+        bool bridgeByRange = false;
+        // Arena events handed to decoding so far.
+        std::size_t dispatched = 0;
+        std::size_t appliedBatches = 0;
+        // Indexed by dispatch order; filled as batches come back decoded.
+        std::vector<std::optional<ReplayBatch>> batches;
+    };
+
+    static constexpr std::chrono::seconds kFeedLatencyWindow{60};
+
+    struct LatencyHistograms {
+        LatencyHistogram dispatch;
+        LatencyHistogram decode;
+        LatencyHistogram apply;
+        LatencyHistogram notify;
+        LatencyHistogram wire;
+        LatencyHistogram snapshotRtt;
+        LatencyHistogram resync;
+        RollingLatencyHistogram exchange{kFeedLatencyWindow};
+        RollingLatencyHistogram feed{kFeedLatencyWindow};
     };
 
     enum class State {
@@ -69,32 +216,81 @@ class BinanceOrderBookSync : public IOrderBookSync {
     void stopImpl();
     void restartBootstrap();
     void resetBootstrapBuffer();
-    void beginBootstrapCycle();
-    void startLiveFeed(uint64_t generation, std::string symbol);
-    void onRawText(uint64_t generation, std::string msg);
+    void beginBootstrapCycle(bool keepBook);
+    void startLiveFeed(uint64_t epoch, std::string symbol);
+    void onFrame(uint64_t epoch, FrameRef frame);
+    void onLinkState(uint64_t epoch, ILiveMarketData::LinkState state);
+    void replayPendingFrames();
+    void onRawText(uint64_t generation, std::string_view msg,
+                   std::chrono::steady_clock::time_point receivedAt);
+    void bufferBootstrapEvent(std::string_view msg,
+                              std::chrono::steady_clock::time_point receivedAt);
+    void resetBootstrapArena();
+    void tryWarmStart();
+    void startReplay(std::size_t from, bool bridgeByRange);
+    void dispatchReplay();
+    void onReplayBatch(uint64_t generation, std::size_t batch, ReplayBatch decoded);
+    void advanceReplay();
+    void finishBootstrap();
     void requestSnapshot(uint64_t generation);
     void onSnapshotReady(uint64_t generation, std::optional<OrderBookSnapshot> snapshot);
+    void scheduleCheckpoint();
+    void writeCheckpoint();
 
-    bool applyDeltaChecked(const OrderBookDelta& delta, const BufferedEvent& meta);
+    bool applyDeltaChecked(const BufferedEvent& event);
     void applySnapshotImpl(const OrderBookSnapshot& snapshot);
     void notifyBookUpdated();
-    static std::optional<BufferedEvent> parseBufferedEvent(std::string raw);
+    void notifyLevelsChanged(const OrderBookDelta& delta);
+    // Records the time since the previous stage of the frame being timed.
+    void markStage(LatencyHistogram& histogram);
+    void recordFeedLatency(const OrderBookDelta& delta);
+    void publishLatency();
 
     boost::asio::strand<boost::asio::io_context::executor_type> strand_;
-    OrderBook book_{};
+    OrderBook book_;
+    NodePool::Options poolOptions_;
     ISnapshotSource& snapshotSource_;
     ILiveMarketData& liveMarketData_;
     OnBookUpdated onBookUpdated_;
+    OnLevelsChanged onLevelsChanged_;
+    ResyncMode resyncMode_ = ResyncMode::KeepStale;
     SyncStats stats_{};
+    LatencyHistograms latency_;
+    std::shared_ptr<const ExchangeClock> exchangeClock_;
+    // Set while a live frame is timed; epoch otherwise.
+    std::chrono::steady_clock::time_point frameReceivedAt_{};
+    std::chrono::steady_clock::time_point stageMark_{};
+    uint32_t updatesSinceLatency_ = 0;
 
     State state_ = State::Stopped;
     std::string symbol_;
     uint64_t generation_ = 0;
+    // Bumped per start/stop of the live feed, which survives resyncs.
+    uint64_t feedEpoch_ = 0;
+    bool linkDown_ = false;
     bool snapshotInFlight_ = false;
-    std::deque<BufferedEvent> bufferedEvents_;
+    BootstrapArena::Options bootstrapBufferOptions_;
+    // Shared with decode workers, which read payloads in place; a cycle
+    // that restarts while they still hold it moves on to a fresh arena.
+    std::shared_ptr<BootstrapArena> bootstrapEvents_ =
+        std::make_shared<BootstrapArena>(bootstrapBufferOptions_);
+    boost::asio::any_io_executor decodeExecutor_;
+    Replay replay_;
+    std::chrono::steady_clock::time_point replayStartedAt_{};
     bool hasFirstBufferedEvent_ = false;
     uint64_t firstBufferedUpdateId_ = 0;
+    std::deque<FrameRef> pendingFrames_;
+    std::chrono::steady_clock::time_point startedAt_{};
+    std::chrono::steady_clock::time_point bootstrapStartedAt_{};
+    std::optional<BookCheckpoint> warmStart_;
+    std::shared_ptr<BookCheckpointWriter> checkpointWriter_;
+    std::chrono::milliseconds checkpointInterval_{0};
+    boost::asio::steady_timer checkpointTimer_{strand_};
+    // Handed back and forth with the writer so its vectors stay allocated.
+    BookCheckpoint checkpointBuffer_;
+    uint64_t checkpointedUpdate_ = 0;
 
     SymbolScales scales_{};
+    bool hasScales_ = false;
     BinanceAPIParser parser_;
 };
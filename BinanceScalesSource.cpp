@@ -10,6 +10,7 @@
 #include <boost/json.hpp>
 #include <cctype>
 #include <format>
+#include <iostream>
 #include <limits>
 #include <openssl/err.h>
 #include <optional>
@@ -25,6 +26,8 @@ namespace json = boost::json;
 constexpr std::string_view host = "fapi.binance.com";
 constexpr std::string_view port = "443";
 constexpr uint64_t kMinPriceScale = 100000000ULL;
+// Unfiltered: one request (weight 1) returns every symbol.
+constexpr std::string_view kExchangeInfoTarget = "/fapi/v1/exchangeInfo";
 
 std::string toUpperCopy(std::string_view value) {
     std::string out(value);
@@ -33,32 +36,36 @@ std::string toUpperCopy(std::string_view value) {
     return out;
 }
 
-std::optional<uint64_t> scaleFromPrecisionField(const boost::json::object& symbolObj,
-                                                std::string_view fieldName) {
+std::optional<int64_t> precisionField(const boost::json::object& symbolObj,
+                                      std::string_view fieldName) {
     const auto* value = symbolObj.if_contains(fieldName);
     if (!value) {
         return std::nullopt;
     }
 
-    int64_t precision = -1;
     if (value->is_int64()) {
-        precision = value->as_int64();
-    } else if (value->is_uint64()) {
+        return value->as_int64();
+    }
+    if (value->is_uint64()) {
         const auto raw = value->as_uint64();
         if (raw > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
             return std::nullopt;
         }
-        precision = static_cast<int64_t>(raw);
-    } else {
-        return std::nullopt;
+        return static_cast<int64_t>(raw);
     }
+    return std::nullopt;
+}
 
-    if (precision <= 0) {
+std::optional<uint64_t> scaleFromPrecision(std::optional<int64_t> precision) {
+    if (!precision) {
+        return std::nullopt;
+    }
+    if (*precision <= 0) {
         return uint64_t{1};
     }
 
     uint64_t scale = 1;
-    for (int64_t i = 0; i < precision; ++i) {
+    for (int64_t i = 0; i < *precision; ++i) {
         if (scale > std::numeric_limits<uint64_t>::max() / 10) {
             return std::nullopt;
         }
@@ -81,6 +88,40 @@ uint64_t scaleFromStepValue(std::string_view step) {
     return scale;
 }
 
+uint64_t scaledStepValue(std::string_view step, uint64_t scale) {
+    const auto dotPos = step.find('.');
+    const std::string_view intPart = step.substr(0, dotPos);
+    const std::string_view fracPart =
+        (dotPos == std::string_view::npos) ? std::string_view{} : step.substr(dotPos + 1);
+
+    uint64_t value = 0;
+    for (const char c : intPart) {
+        if (c < '0' || c > '9') {
+            return 1;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+
+    uint64_t fracScale = scale;
+    for (const char c : fracPart) {
+        if (c < '0' || c > '9') {
+            return 1;
+        }
+        if (fracScale < 10) {
+            // Finer than the configured scale: cannot be represented exactly.
+            if (c != '0') {
+                return 1;
+            }
+            continue;
+        }
+        fracScale /= 10;
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+
+    value *= fracScale;
+    return value == 0 ? 1 : value;
+}
+
 std::string fetchExchangeInfoBody(std::string_view target) {
     asio::io_context io;
     ssl::context tls{ssl::context::tls_client};
@@ -158,14 +199,13 @@ const json::object& findSymbolObject(const json::object& root, std::string_view
     throw std::runtime_error(std::format("Symbol not found in exchangeInfo: {}", wantedSymbol));
 }
 
-std::pair<std::string, std::string> extractTickAndStep(const json::object& symbolObj) {
+std::optional<SymbolFilters> extractFilters(const json::object& symbolObj) {
     const auto* filtersValue = symbolObj.if_contains("filters");
     if (!filtersValue || !filtersValue->is_array()) {
-        throw std::runtime_error("exchangeInfo.symbol.filters is missing");
+        return std::nullopt;
     }
 
-    std::string tickSize;
-    std::string stepSize;
+    SymbolFilters filters;
     for (const auto& filterValue : filtersValue->as_array()) {
         if (!filterValue.is_object()) {
             continue;
@@ -181,37 +221,77 @@ std::pair<std::string, std::string> extractTickAndStep(const json::object& symbo
         if (type == "PRICE_FILTER") {
             const auto* tick = filter.if_contains("tickSize");
             if (tick && tick->is_string()) {
-                tickSize = std::string(tick->as_string().data(), tick->as_string().size());
+                filters.tickSize = std::string(tick->as_string().data(), tick->as_string().size());
             }
         } else if (type == "LOT_SIZE") {
             const auto* step = filter.if_contains("stepSize");
             if (step && step->is_string()) {
-                stepSize = std::string(step->as_string().data(), step->as_string().size());
+                filters.stepSize = std::string(step->as_string().data(), step->as_string().size());
             }
         }
     }
 
-    if (tickSize.empty() || stepSize.empty()) {
-        throw std::runtime_error("Missing PRICE_FILTER.tickSize or LOT_SIZE.stepSize");
+    if (filters.tickSize.empty() || filters.stepSize.empty()) {
+        return std::nullopt;
     }
-
-    return {std::move(tickSize), std::move(stepSize)};
+    filters.pricePrecision = precisionField(symbolObj, "pricePrecision");
+    filters.quantityPrecision = precisionField(symbolObj, "quantityPrecision");
+    return filters;
 }
 
-SymbolScales buildScales(const json::object& symbolObj, std::string_view tickSize,
-                         std::string_view stepSize) {
+SymbolScales buildScales(const SymbolFilters& filters) {
     SymbolScales scales{};
-    scales.priceScale = scaleFromStepValue(tickSize);
-    scales.qtyScale = scaleFromStepValue(stepSize);
-    if (const auto precisionScale = scaleFromPrecisionField(symbolObj, "pricePrecision")) {
+    scales.priceScale = scaleFromStepValue(filters.tickSize);
+    scales.qtyScale = scaleFromStepValue(filters.stepSize);
+    if (const auto precisionScale = scaleFromPrecision(filters.pricePrecision)) {
         scales.priceScale = std::max(scales.priceScale, *precisionScale);
     }
-    if (const auto precisionScale = scaleFromPrecisionField(symbolObj, "quantityPrecision")) {
+    if (const auto precisionScale = scaleFromPrecision(filters.quantityPrecision)) {
         scales.qtyScale = std::max(scales.qtyScale, *precisionScale);
     }
     scales.priceScale = std::max(scales.priceScale, kMinPriceScale);
+    scales.priceTick = scaledStepValue(filters.tickSize, scales.priceScale);
     return scales;
 }
+
+// Filters of every symbol in an unfiltered exchangeInfo body.
+ScalesCache::FiltersBySymbol extractAllFilters(std::string_view body) {
+    const auto parsed = parseExchangeInfo(body);
+    const auto* symbolsValue = parsed.as_object().if_contains("symbols");
+    if (!symbolsValue || !symbolsValue->is_array()) {
+        throw std::runtime_error("exchangeInfo response missing symbols array");
+    }
+
+    ScalesCache::FiltersBySymbol out;
+    for (const auto& symbolValue : symbolsValue->as_array()) {
+        if (!symbolValue.is_object()) {
+            continue;
+        }
+        const auto& symbolObj = symbolValue.as_object();
+        const auto* symbolName = symbolObj.if_contains("symbol");
+        if (!symbolName || !symbolName->is_string()) {
+            continue;
+        }
+        if (auto filters = extractFilters(symbolObj)) {
+            out.emplace(std::string(symbolName->as_string().data(), symbolName->as_string().size()),
+                        std::move(*filters));
+        }
+    }
+    return out;
+}
+
+BinanceScalesSource::ScalesBySymbol selectScales(const ScalesCache::FiltersBySymbol& filters,
+                                                 const std::vector<std::string>& symbols) {
+    BinanceScalesSource::ScalesBySymbol out;
+    for (const auto& symbol : symbols) {
+        const std::string wanted = toUpperCopy(symbol);
+        const auto it = filters.find(wanted);
+        if (it != filters.end()) {
+            out.emplace(wanted, buildScales(it->second));
+        }
+    }
+    return out;
+}
 } // namespace
 
 SymbolScales BinanceScalesSource::getScales(std::string_view symbol) const {
@@ -220,8 +300,47 @@ SymbolScales BinanceScalesSource::getScales(std::string_view symbol) const {
     const auto& root = parsed.as_object();
     const std::string wantedSymbol = toUpperCopy(symbol);
     const auto& symbolObj = findSymbolObject(root, wantedSymbol);
-    const auto [tickSize, stepSize] = extractTickAndStep(symbolObj);
-    return buildScales(symbolObj, tickSize, stepSize);
+    const auto filters = extractFilters(symbolObj);
+    if (!filters) {
+        throw std::runtime_error("Missing PRICE_FILTER.tickSize or LOT_SIZE.stepSize");
+    }
+    return buildScales(*filters);
+}
+
+BinanceScalesSource::ScalesBySymbol
+BinanceScalesSource::loadCached(const std::vector<std::string>& symbols) const {
+    return selectScales(cache_.load(), symbols);
+}
+
+void BinanceScalesSource::fetchAsync(std::vector<std::string> symbols, OnScales onScales) {
+    if (!client_) {
+        onScales(std::nullopt);
+        return;
+    }
+    client_->get(std::string(kExchangeInfoTarget),
+                 [cache = cache_, symbols = std::move(symbols),
+                  onScales = std::move(onScales)](std::optional<HttpsClient::Response> response) {
+                     if (!response || response->status != 200) {
+                         std::cerr << "BinanceScalesSource exchangeInfo fetch failed";
+                         if (response) {
+                             std::cerr << ": HTTP " << response->status;
+                         }
+                         std::cerr << '\n';
+                         onScales(std::nullopt);
+                         return;
+                     }
+
+                     std::optional<ScalesBySymbol> scales;
+                     try {
+                         const auto filters = extractAllFilters(response->body);
+                         cache.store(filters);
+                         scales = selectScales(filters, symbols);
+                     } catch (const std::exception& e) {
+                         std::cerr << "BinanceScalesSource exchangeInfo invalid: " << e.what()
+                                   << '\n';
+                     }
+                     onScales(std::move(scales));
+                 });
 }
 
 std::string BinanceScalesSource::buildUrl(std::string_view symbol) const {
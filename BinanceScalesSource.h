@@ -1,16 +1,44 @@
 #pragma once
 
+#include "HttpsClient.h"
+#include "ScalesCache.h"
 #include "Types.h"
 
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 class BinanceScalesSource {
   public:
+    // Keyed by uppercase symbol.
+    using ScalesBySymbol = std::map<std::string, SymbolScales>;
+    using OnScales = std::function<void(std::optional<ScalesBySymbol>)>;
+
+    BinanceScalesSource() = default;
+    BinanceScalesSource(std::shared_ptr<HttpsClient> client, ScalesCache cache)
+        : client_(std::move(client)), cache_(std::move(cache)) {
+    }
+
+    // Blocking single-symbol lookup on a private connection.
     SymbolScales getScales(std::string_view symbol) const;
 
+    // Scales from the disk cache when it is valid and within its TTL.
+    ScalesBySymbol loadCached(const std::vector<std::string>& symbols) const;
+    // One unfiltered exchangeInfo request for all `symbols`; refreshes the
+    // disk cache. Symbols the exchange does not list are absent from the
+    // result; nullopt means the fetch itself failed. Runs `onScales` on the
+    // client's strand.
+    void fetchAsync(std::vector<std::string> symbols, OnScales onScales);
+
   private:
     std::string buildUrl(std::string_view symbol) const;
     static uint64_t scaleFromStep(std::string_view step);
+
+    std::shared_ptr<HttpsClient> client_;
+    ScalesCache cache_;
 };
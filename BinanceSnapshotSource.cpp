@@ -2,30 +2,24 @@
 
 #include "BinanceAPIParser.h"
 
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
 #include <algorithm>
-#include <boost/asio.hpp>
-#include <boost/asio/ssl.hpp>
-#include <boost/asio/ssl/host_name_verification.hpp>
-#include <boost/beast/core.hpp>
-#include <boost/beast/http.hpp>
-#include <boost/beast/ssl.hpp>
 #include <cctype>
 #include <format>
 #include <iostream>
-#include <memory>
-#include <mutex>
-#include <openssl/err.h>
 #include <string_view>
+#include <utility>
 
 namespace {
-namespace asio = boost::asio;
-namespace ssl = asio::ssl;
-namespace beast = boost::beast;
-namespace http = beast::http;
-using tcp = asio::ip::tcp;
-
-constexpr std::string_view kHost = "fapi.binance.com";
-constexpr std::string_view kPort = "443";
+constexpr std::string_view kPingTarget = "/fapi/v1/ping";
+// USD-M futures: depth with limit=1000 costs 20 of 2400 weight per minute.
+// Hedges stop while less than a quarter of the minute's weight is left.
+constexpr uint64_t kDepthWeight = 20;
+constexpr uint64_t kWeightPerMinute = 2400;
+constexpr uint64_t kHedgeReserve = kWeightPerMinute / 4;
+constexpr std::size_t kLatencyWindow = 64;
+constexpr std::size_t kMinLatencySamples = 8;
 
 std::string toUpperCopy(std::string_view value) {
     std::string out(value);
@@ -33,226 +27,294 @@ std::string toUpperCopy(std::string_view value) {
                    [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
     return out;
 }
-} // namespace
 
-struct BinanceSnapshotSource::Request : public std::enable_shared_from_this<Request> {
-    Request(asio::io_context& io, ssl::context& sslContext, std::string depthTarget,
-            SymbolScales scales, OnSnapshot onSnapshot)
-        : strand_(asio::make_strand(io)),
-          resolver_(strand_),
-          stream_(strand_, sslContext),
-          depthTarget_(std::move(depthTarget)),
-          scales_(scales),
-          onSnapshot_(std::move(onSnapshot)) {
+std::optional<OrderBookSnapshot> parseResponse(const std::optional<HttpsClient::Response>& response,
+                                               const SymbolScales& scales) {
+    if (!response) {
+        std::cerr << "BinanceSnapshotSource depth request failed\n";
+        return std::nullopt;
     }
-
-    void startAsync() {
-        asio::post(strand_, [self = shared_from_this()]() { self->start(); });
+    if (response->status != 200) {
+        std::cerr << "BinanceSnapshotSource depth HTTP " << response->status << '\n';
+        return std::nullopt;
+    }
+    const BinanceAPIParser parser{scales};
+    auto parsed = parser.parseSnapshot(response->body);
+    if (parsed.lastUpdate == 0) {
+        return std::nullopt;
     }
+    return parsed;
+}
+} // namespace
+
+BinanceSnapshotSource::BinanceSnapshotSource(std::shared_ptr<HttpsClient> client,
+                                             std::string symbol, SymbolScales scales,
+                                             std::shared_ptr<RequestWeightBudget> budget,
+                                             HedgePolicy policy)
+    : symbol_(std::move(symbol)),
+      shared_(std::make_shared<Shared>()),
+      scales_(scales) {
+    shared_->client = std::move(client);
+    shared_->budget = budget ? std::move(budget) : makeBudget();
+    shared_->policy = policy;
+    shared_->depthTarget = buildDepthUrl();
+}
+
+BinanceSnapshotSource::~BinanceSnapshotSource() {
+    cancelPending();
+}
+
+void BinanceSnapshotSource::getSnapshotAsync(OnSnapshot onSnapshot) {
+    cancelPending();
 
-    void cancelAsync() {
+    auto pending = std::make_shared<Pending>();
+    pending->onSnapshot = std::move(onSnapshot);
+    SymbolScales scales;
+    {
         std::lock_guard<std::mutex> lock(mutex_);
-        canceled_ = true;
-        onSnapshot_ = nullptr;
-        asio::post(strand_, [self = shared_from_this()]() { self->cancel(); });
+        scales = scales_;
+        pending_ = pending;
     }
 
-  private:
-    void fail(const char* context, beast::error_code ec) {
-        std::cerr << "BinanceSnapshotSource " << context << " failed: " << ec.message() << '\n';
-        complete(std::nullopt);
+    send(shared_, pending, scales, false);
+    if (shared_->policy.enabled && shared_->policy.maxRequests > 1) {
+        armHedge(shared_, pending, scales);
     }
+}
 
-    void failHttp(const char* context) {
-        std::cerr << "BinanceSnapshotSource " << context << " HTTP "
-                  << static_cast<unsigned>(res_.result_int()) << ": " << res_.reason() << '\n';
-        complete(std::nullopt);
-    }
+void BinanceSnapshotSource::setOnRawSnapshot(OnRawSnapshot onRawSnapshot) {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    shared_->onRawSnapshot = std::move(onRawSnapshot);
+}
 
-    void start() {
-        resolver_.async_resolve(kHost, kPort,
-                                beast::bind_front_handler(&Request::onResolve, shared_from_this()));
-    }
+void BinanceSnapshotSource::setScales(SymbolScales scales) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scales_ = scales;
+}
 
-    void cancel() {
-        beast::error_code ignored;
-        auto& socket = beast::get_lowest_layer(stream_).socket();
-        resolver_.cancel();
-        socket.cancel(ignored);
-        socket.shutdown(tcp::socket::shutdown_both, ignored);
-        socket.close(ignored);
-    }
+BinanceSnapshotSource::Stats BinanceSnapshotSource::stats() const {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    return shared_->stats;
+}
 
-    void onResolve(beast::error_code ec, const tcp::resolver::results_type& results) {
-        if (ec) {
-            fail("resolve", ec);
-            return;
-        }
+HttpsClient::Options BinanceSnapshotSource::restOptions(const BinanceHosts& hosts) {
+    HttpsClient::Options options;
+    options.host = hosts.rest;
+    options.port = hosts.restPort;
+    options.pingTarget = std::string(kPingTarget);
+    options.caFile = hosts.caFile;
+    return options;
+}
 
-        beast::get_lowest_layer(stream_).expires_after(std::chrono::seconds(10));
-        beast::get_lowest_layer(stream_).async_connect(
-            results, beast::bind_front_handler(&Request::onConnect, shared_from_this()));
+std::shared_ptr<RequestWeightBudget> BinanceSnapshotSource::makeBudget() {
+    return std::make_shared<RequestWeightBudget>(kWeightPerMinute, kHedgeReserve);
+}
+
+std::string BinanceSnapshotSource::buildDepthUrl() const {
+    const std::string upperedSymbol = toUpperCopy(symbol_);
+    return std::format("/fapi/v1/depth?symbol={}&limit=1000", upperedSymbol);
+}
+
+void BinanceSnapshotSource::send(const std::shared_ptr<Shared>& shared,
+                                 const std::shared_ptr<Pending>& pending, SymbolScales scales,
+                                 bool hedge) {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        ++shared->stats.requests;
+        if (hedge) {
+            ++shared->stats.hedges;
+        }
+    }
+    if (!hedge) {
+        shared->budget->charge(kDepthWeight);
+    }
+    std::size_t slot = 0;
+    {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        ++pending->outstanding;
+        slot = pending->requests.size();
+        pending->requests.push_back(Request{.sentAt = std::chrono::steady_clock::now()});
     }
 
-    void onConnect(beast::error_code ec, const tcp::resolver::results_type::endpoint_type&) {
-        if (ec) {
-            fail("connect", ec);
+    const auto id = shared->client->get(
+        shared->depthTarget,
+        [shared, pending, scales, slot, hedge](std::optional<HttpsClient::Response> response) {
+            onResponse(shared, pending, scales, slot, hedge, response);
+        });
+    std::lock_guard<std::mutex> lock(pending->mutex);
+    pending->requests[slot].id = id;
+}
+
+// The first parsed snapshot wins; a failed request only fails the fetch
+// once no other request is still out. Losers are cancelled: a queued one
+// never goes out, one on the wire completes without its callback. Their
+// time so far still enters the latency window as a lower bound, since
+// counting only winners would drop exactly the slow tail the hedge
+// deadline is meant to cut.
+void BinanceSnapshotSource::onResponse(const std::shared_ptr<Shared>& shared,
+                                       const std::shared_ptr<Pending>& pending,
+                                       SymbolScales scales, std::size_t slot, bool hedge,
+                                       const std::optional<HttpsClient::Response>& response) {
+    const auto now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration latency{};
+    {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        auto& request = pending->requests[slot];
+        // Cancelled after its response was already on the way.
+        if (request.done) {
             return;
         }
-
-        if (!SSL_set_tlsext_host_name(stream_.native_handle(), kHost.data())) {
-            std::cerr << "BinanceSnapshotSource SNI setup failed\n";
-            complete(std::nullopt);
+        request.done = true;
+        --pending->outstanding;
+        latency = now - request.sentAt;
+        if (!pending->onSnapshot) {
             return;
         }
-
-        stream_.set_verify_callback(ssl::host_name_verification(std::string(kHost)));
-        stream_.async_handshake(
-            ssl::stream_base::client,
-            beast::bind_front_handler(&Request::onTlsHandshake, shared_from_this()));
     }
 
-    void onTlsHandshake(beast::error_code ec) {
-        if (ec) {
-            fail("TLS handshake", ec);
+    // Responses run on the client strand one at a time, so only
+    // cancelPending() can take the callback meanwhile.
+    auto snapshot = parseResponse(response, scales);
+    OnSnapshot callback;
+    std::vector<HttpsClient::RequestId> losers;
+    std::vector<std::chrono::steady_clock::duration> loserLatencies;
+    {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (!pending->onSnapshot || (!snapshot && pending->outstanding > 0)) {
             return;
         }
-        sendDepthRequest();
+        callback = std::move(pending->onSnapshot);
+        pending->onSnapshot = nullptr;
+        for (auto& request : pending->requests) {
+            if (!request.done) {
+                request.done = true;
+                losers.push_back(request.id);
+                loserLatencies.push_back(now - request.sentAt);
+            }
+        }
     }
-
-    void sendDepthRequest() {
-        req_ = http::request<http::empty_body>{http::verb::get, depthTarget_, 11};
-        req_.set(http::field::host, kHost);
-        req_.set(http::field::user_agent, "orderbook/1.0");
-        req_.keep_alive(false);
-
-        http::async_write(stream_, req_,
-                          beast::bind_front_handler(&Request::onWriteDepth, shared_from_this()));
+    cancelHedge(shared, pending);
+    for (const auto loser : losers) {
+        shared->client->cancel(loser);
     }
 
-    void onWriteDepth(beast::error_code ec, std::size_t) {
-        if (ec) {
-            fail("depth write", ec);
-            return;
+    OnRawSnapshot onRawSnapshot;
+    if (snapshot) {
+        recordLatency(*shared, latency);
+        for (const auto loserLatency : loserLatencies) {
+            recordLatency(*shared, loserLatency);
+        }
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        onRawSnapshot = shared->onRawSnapshot;
+        if (hedge) {
+            ++shared->stats.hedgeWins;
         }
+    }
+    if (onRawSnapshot) {
+        onRawSnapshot(response->body);
+    }
+    callback(std::move(snapshot));
+}
 
-        http::async_read(stream_, buffer_, res_,
-                         beast::bind_front_handler(&Request::onReadDepth, shared_from_this()));
+void BinanceSnapshotSource::recordLatency(Shared& shared,
+                                          std::chrono::steady_clock::duration latency) {
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.latencies.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(latency));
+    if (shared.latencies.size() > kLatencyWindow) {
+        shared.latencies.pop_front();
     }
+}
 
-    void onReadDepth(beast::error_code ec, std::size_t) {
-        if (ec) {
-            fail("depth read", ec);
-            return;
-        }
-        if (res_.result() != http::status::ok) {
-            failHttp("depth");
-            return;
+// The timer is only ever touched on the client strand.
+void BinanceSnapshotSource::armHedge(const std::shared_ptr<Shared>& shared,
+                                     const std::shared_ptr<Pending>& pending,
+                                     SymbolScales scales) {
+    boost::asio::dispatch(shared->client->executor(), [shared, pending, scales]() {
+        startHedgeTimer(shared, pending, scales);
+    });
+}
+
+void BinanceSnapshotSource::cancelHedge(const std::shared_ptr<Shared>& shared,
+                                        const std::shared_ptr<Pending>& pending) {
+    boost::asio::post(shared->client->executor(), [pending]() {
+        if (pending->hedgeTimer) {
+            pending->hedgeTimer->cancel();
         }
+    });
+}
 
-        const BinanceAPIParser parser{scales_};
-        const auto snapshot = parser.parseSnapshot(res_.body());
-        if (snapshot.lastUpdate == 0) {
-            complete(std::nullopt);
+void BinanceSnapshotSource::startHedgeTimer(const std::shared_ptr<Shared>& shared,
+                                            const std::shared_ptr<Pending>& pending,
+                                            SymbolScales scales) {
+    {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (!pending->onSnapshot) {
             return;
         }
-
-        result_ = std::move(snapshot);
-        stream_.async_shutdown(beast::bind_front_handler(&Request::onShutdown, shared_from_this()));
     }
-
-    void onShutdown(beast::error_code ec) {
-        if (ec == asio::ssl::error::stream_truncated || ec == asio::error::eof) {
-            ec = {};
-        }
+    pending->hedgeTimer =
+        std::make_unique<boost::asio::steady_timer>(shared->client->executor(), hedgeDelay(*shared));
+    pending->hedgeTimer->async_wait([shared, pending, scales](const boost::system::error_code& ec) {
         if (ec) {
-            fail("shutdown", ec);
             return;
         }
-
-        complete(std::move(result_));
-    }
-
-    void complete(std::optional<OrderBookSnapshot> snapshot) {
-        OnSnapshot callback;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (done_ || canceled_) {
-                done_ = true;
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            if (!pending->onSnapshot ||
+                pending->requests.size() >= shared->policy.maxRequests) {
                 return;
             }
-            done_ = true;
-            callback = std::move(onSnapshot_);
         }
-
-        if (callback) {
-            callback(std::move(snapshot));
+        if (!shared->budget->tryAcquire(kDepthWeight)) {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            ++shared->stats.hedgesOverBudget;
+            return;
         }
-    }
-
-    asio::strand<asio::io_context::executor_type> strand_;
-    tcp::resolver resolver_;
-    beast::ssl_stream<beast::tcp_stream> stream_;
-    beast::flat_buffer buffer_;
-    http::request<http::empty_body> req_;
-    http::response<http::string_body> res_;
-    std::string depthTarget_;
-    SymbolScales scales_{};
-    std::optional<OrderBookSnapshot> result_;
-    OnSnapshot onSnapshot_;
-    std::mutex mutex_;
-    bool done_ = false;
-    bool canceled_ = false;
-};
+        send(shared, pending, scales, true);
+        startHedgeTimer(shared, pending, scales);
+    });
+}
 
-BinanceSnapshotSource::~BinanceSnapshotSource() {
-    std::shared_ptr<Request> request;
+std::chrono::milliseconds BinanceSnapshotSource::hedgeDelay(Shared& shared) {
+    const auto& policy = shared.policy;
+    std::vector<std::chrono::milliseconds> samples;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        request = std::move(request_);
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        samples.assign(shared.latencies.begin(), shared.latencies.end());
     }
-    if (request) {
-        request->cancelAsync();
+    if (samples.size() < kMinLatencySamples) {
+        return policy.initialDelay;
     }
+    const auto rank = static_cast<std::size_t>(policy.percentile * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank),
+                     samples.end());
+    return std::clamp(samples[rank], policy.minDelay, policy.maxDelay);
 }
 
-void BinanceSnapshotSource::getSnapshotAsync(OnSnapshot onSnapshot) {
-    try {
-        ensureTlsContextConfigured();
-    } catch (const boost::system::system_error& e) {
-        std::cerr << "BinanceSnapshotSource TLS context setup failed: " << e.code().message()
-                  << '\n';
-        if (onSnapshot) {
-            onSnapshot(std::nullopt);
-        }
+// A superseded or abandoned request must never call back: its callback is
+// dropped here under the pending mutex, and the client is told to forget it.
+void BinanceSnapshotSource::cancelPending() {
+    std::shared_ptr<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending = std::move(pending_);
+    }
+    if (!pending) {
         return;
     }
-
-    auto request = std::make_shared<Request>(ioContext_, sslContext_, buildDepthUrl(), scales_,
-                                             std::move(onSnapshot));
-
-    std::shared_ptr<Request> oldRequest;
+    std::vector<HttpsClient::RequestId> requests;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        oldRequest = std::move(request_);
-        request_ = request;
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        pending->onSnapshot = nullptr;
+        for (auto& request : pending->requests) {
+            if (!request.done) {
+                request.done = true;
+                requests.push_back(request.id);
+            }
+        }
     }
-
-    if (oldRequest) {
-        oldRequest->cancelAsync();
+    cancelHedge(shared_, pending);
+    for (const auto id : requests) {
+        shared_->client->cancel(id);
     }
-
-    request->startAsync();
-}
-
-std::string BinanceSnapshotSource::buildDepthUrl() const {
-    const std::string upperedSymbol = toUpperCopy(symbol_);
-    return std::format("/fapi/v1/depth?symbol={}&limit=1000", upperedSymbol);
-}
-
-void BinanceSnapshotSource::ensureTlsContextConfigured() {
-    std::call_once(tlsContextInitOnce_, [this]() {
-        sslContext_.set_default_verify_paths();
-        sslContext_.set_verify_mode(ssl::verify_peer);
-    });
 }
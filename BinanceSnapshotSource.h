@@ -1,36 +1,128 @@
 #pragma once
 
+#include "BinanceHosts.h"
+#include "HttpsClient.h"
 #include "ISnapshotSource.h"
+#include "RequestWeightBudget.h"
 
 #include <boost/asio/io_context.hpp>
-#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
+// Fetches depth snapshots, hedging slow ones: when a request has not
+// answered by the `percentile` of recent snapshot latencies, a second
+// identical request is sent, the first parsed snapshot wins and the other
+// is cancelled. Hedges are only sent while the weight budget allows.
 class BinanceSnapshotSource : public ISnapshotSource {
   public:
+    struct HedgePolicy {
+        bool enabled = true;
+        double percentile = 0.95;
+        // Deadline until enough latencies have been observed.
+        std::chrono::milliseconds initialDelay{400};
+        std::chrono::milliseconds minDelay{50};
+        std::chrono::milliseconds maxDelay{2000};
+        std::size_t maxRequests = 2;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t hedges = 0;
+        uint64_t hedgeWins = 0;
+        uint64_t hedgesOverBudget = 0;
+    };
+
+    // Owns a private keep-alive connection to the REST host.
     explicit BinanceSnapshotSource(boost::asio::io_context& ioContext, std::string symbol,
                                    SymbolScales scales)
-        : ioContext_(ioContext),
-          sslContext_(boost::asio::ssl::context::tls_client),
-          symbol_(std::move(symbol)),
-          scales_(scales) {
+        : BinanceSnapshotSource(HttpsClient::create(ioContext, restOptions()), std::move(symbol),
+                                scales) {
     }
+    // Shares `client`, e.g. with the other symbols of a shard, and `budget`
+    // with every source hitting the same host.
+    BinanceSnapshotSource(std::shared_ptr<HttpsClient> client, std::string symbol,
+                          SymbolScales scales, std::shared_ptr<RequestWeightBudget> budget = {})
+        : BinanceSnapshotSource(std::move(client), std::move(symbol), scales, std::move(budget),
+                                HedgePolicy{}) {
+    }
+    BinanceSnapshotSource(std::shared_ptr<HttpsClient> client, std::string symbol,
+                          SymbolScales scales, std::shared_ptr<RequestWeightBudget> budget,
+                          HedgePolicy policy);
     ~BinanceSnapshotSource() override;
 
     void getSnapshotAsync(OnSnapshot onSnapshot) override final;
+    void setOnRawSnapshot(OnRawSnapshot onRawSnapshot) override final;
+    // Applies to requests issued after the call.
+    void setScales(SymbolScales scales);
+    Stats stats() const;
+
+    static HttpsClient::Options restOptions(const BinanceHosts& hosts = {});
+    // Binance weights and limits for the depth endpoint.
+    static std::shared_ptr<RequestWeightBudget> makeBudget();
 
   private:
-    struct Request;
+    struct Request {
+        HttpsClient::RequestId id = 0;
+        std::chrono::steady_clock::time_point sentAt{};
+        // Answered, or cancelled once the fetch was decided or abandoned.
+        bool done = false;
+    };
+
+    struct Pending {
+        std::mutex mutex;
+        OnSnapshot onSnapshot;
+        // Every request sent for this fetch, in send order; responses find
+        // theirs by index.
+        std::vector<Request> requests;
+        std::size_t outstanding = 0;
+        // Client strand only.
+        std::unique_ptr<boost::asio::steady_timer> hedgeTimer;
+    };
+
+    // Everything a response may touch; outlives the source while requests
+    // are still on the wire.
+    struct Shared {
+        std::shared_ptr<HttpsClient> client;
+        std::shared_ptr<RequestWeightBudget> budget;
+        HedgePolicy policy;
+        std::string depthTarget;
+        std::mutex mutex;
+        // Most recent snapshot latencies, oldest first. A loser counts with
+        // its time so far when the winner landed, a lower bound.
+        std::deque<std::chrono::milliseconds> latencies;
+        Stats stats{};
+        OnRawSnapshot onRawSnapshot;
+    };
+
     std::string buildDepthUrl() const;
-    void ensureTlsContextConfigured();
+    static void send(const std::shared_ptr<Shared>& shared, const std::shared_ptr<Pending>& pending,
+                     SymbolScales scales, bool hedge);
+    static void onResponse(const std::shared_ptr<Shared>& shared,
+                           const std::shared_ptr<Pending>& pending, SymbolScales scales,
+                           std::size_t slot, bool hedge,
+                           const std::optional<HttpsClient::Response>& response);
+    static void recordLatency(Shared& shared, std::chrono::steady_clock::duration latency);
+    static void armHedge(const std::shared_ptr<Shared>& shared,
+                         const std::shared_ptr<Pending>& pending, SymbolScales scales);
+    static void startHedgeTimer(const std::shared_ptr<Shared>& shared,
+                                const std::shared_ptr<Pending>& pending, SymbolScales scales);
+    static void cancelHedge(const std::shared_ptr<Shared>& shared,
+                            const std::shared_ptr<Pending>& pending);
+    static std::chrono::milliseconds hedgeDelay(Shared& shared);
+    void cancelPending();
 
-    boost::asio::io_context& ioContext_;
-    boost::asio::ssl::context sslContext_;
     const std::string symbol_;
-    const SymbolScales scales_;
-    std::once_flag tlsContextInitOnce_;
+    const std::shared_ptr<Shared> shared_;
     std::mutex mutex_;
-    std::shared_ptr<Request> request_;
+    SymbolScales scales_;
+    std::shared_ptr<Pending> pending_;
 };
@@ -0,0 +1,148 @@
+#include "BookCheckpoint.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace {
+constexpr char kMagic[8] = {'O', 'B', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t symbolBytes;
+    uint64_t priceScale;
+    uint64_t qtyScale;
+    uint64_t priceTick;
+    uint64_t lastUpdate;
+    uint64_t bids;
+    uint64_t asks;
+};
+
+static_assert(std::is_trivially_copyable_v<Level> && sizeof(Level) == 2 * sizeof(uint64_t),
+              "levels are written as raw (price, qty) pairs");
+
+uint64_t checksum(std::string_view bytes) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (const unsigned char c : bytes) {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+std::size_t padded(std::size_t bytes) {
+    return (bytes + 7) & ~std::size_t{7};
+}
+
+void appendLevels(std::string& out, const std::vector<Level>& levels) {
+    out.append(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(Level));
+}
+
+bool readLevels(std::string_view& in, uint64_t count, std::vector<Level>& levels) {
+    if (count > in.size() / sizeof(Level)) {
+        return false;
+    }
+    levels.resize(static_cast<std::size_t>(count));
+    std::memcpy(levels.data(), in.data(), levels.size() * sizeof(Level));
+    in.remove_prefix(levels.size() * sizeof(Level));
+    return true;
+}
+} // namespace
+
+void BookCheckpoint::encode(std::string& out) const {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.symbolBytes = static_cast<uint32_t>(symbol.size());
+    header.priceScale = scales.priceScale;
+    header.qtyScale = scales.qtyScale;
+    header.priceTick = scales.priceTick;
+    header.lastUpdate = book.lastUpdate;
+    header.bids = book.bids.size();
+    header.asks = book.asks.size();
+
+    out.clear();
+    out.reserve(sizeof(header) + padded(symbol.size()) +
+                (book.bids.size() + book.asks.size()) * sizeof(Level) + sizeof(uint64_t));
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(symbol);
+    out.append(padded(symbol.size()) - symbol.size(), '\0');
+    appendLevels(out, book.bids);
+    appendLevels(out, book.asks);
+    const uint64_t sum = checksum(out);
+    out.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+}
+
+std::optional<BookCheckpoint> BookCheckpoint::decode(std::string_view bytes) {
+    Header header{};
+    uint64_t sum = 0;
+    if (bytes.size() < sizeof(header) + sizeof(sum)) {
+        return std::nullopt;
+    }
+    std::memcpy(&sum, bytes.data() + bytes.size() - sizeof(sum), sizeof(sum));
+    bytes.remove_suffix(sizeof(sum));
+    if (checksum(bytes) != sum) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    bytes.remove_prefix(sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        padded(header.symbolBytes) > bytes.size()) {
+        return std::nullopt;
+    }
+
+    BookCheckpoint checkpoint;
+    checkpoint.symbol.assign(bytes.data(), header.symbolBytes);
+    bytes.remove_prefix(padded(header.symbolBytes));
+    checkpoint.scales = SymbolScales{
+        .priceScale = header.priceScale,
+        .qtyScale = header.qtyScale,
+        .priceTick = header.priceTick,
+    };
+    checkpoint.book.lastUpdate = header.lastUpdate;
+    if (!readLevels(bytes, header.bids, checkpoint.book.bids) ||
+        !readLevels(bytes, header.asks, checkpoint.book.asks) || !bytes.empty()) {
+        return std::nullopt;
+    }
+    return checkpoint;
+}
+
+bool BookCheckpoint::store(const std::string& path, std::string& scratch) const {
+    encode(scratch);
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(scratch.data(), static_cast<std::streamsize>(scratch.size())) ||
+            !file.flush()) {
+            std::cerr << "BookCheckpoint cannot write " << tmpPath << '\n';
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::cerr << "BookCheckpoint cannot replace " << path << ": " << ec.message() << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<BookCheckpoint> BookCheckpoint::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    return decode(bytes);
+}
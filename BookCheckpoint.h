@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Types.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Full-depth image of a synced book, for warm restarts: every level plus
+// the update id it is current as of and the scales its integers are in.
+//
+// The file is a fixed little-endian header, the symbol padded to 8 bytes,
+// bids then asks as (price, qty) uint64 pairs in book order, and an FNV-1a
+// checksum of everything before it. Anything truncated, foreign or from
+// another version loads as nothing.
+struct BookCheckpoint {
+    std::string symbol;
+    SymbolScales scales{};
+    OrderBookSnapshot book;
+
+    // Encodes into `out`, reusing its capacity.
+    void encode(std::string& out) const;
+    static std::optional<BookCheckpoint> decode(std::string_view bytes);
+
+    // Encodes through `scratch` into a temporary file renamed over `path`.
+    bool store(const std::string& path, std::string& scratch) const;
+    static std::optional<BookCheckpoint> load(const std::string& path);
+};
@@ -0,0 +1,111 @@
+#include "BookCheckpointWriter.h"
+
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+namespace {
+constexpr std::string_view kSuffix = ".ckpt";
+} // namespace
+
+std::shared_ptr<BookCheckpointWriter> BookCheckpointWriter::create(std::string directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "BookCheckpointWriter cannot create " << directory << ": " << ec.message()
+                  << '\n';
+        return nullptr;
+    }
+    return std::shared_ptr<BookCheckpointWriter>(new BookCheckpointWriter(std::move(directory)));
+}
+
+BookCheckpointWriter::BookCheckpointWriter(std::string directory)
+    : directory_(std::move(directory)) {
+    writer_ = std::thread([this]() { run(); });
+}
+
+BookCheckpointWriter::~BookCheckpointWriter() {
+    close();
+}
+
+void BookCheckpointWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+BookCheckpoint BookCheckpointWriter::submit(BookCheckpoint checkpoint) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return checkpoint;
+    }
+    auto& slot = slots_[checkpoint.symbol];
+    BookCheckpoint recycled;
+    if (slot.pending) {
+        recycled = std::move(*slot.pending);
+        ++stats_.superseded;
+    } else {
+        recycled = std::move(slot.spare);
+    }
+    slot.pending = std::move(checkpoint);
+    wake_.notify_one();
+    return recycled;
+}
+
+std::optional<BookCheckpoint> BookCheckpointWriter::load(std::string_view symbol) const {
+    auto checkpoint = BookCheckpoint::load(pathFor(symbol));
+    if (checkpoint && checkpoint->symbol != symbol) {
+        return std::nullopt;
+    }
+    return checkpoint;
+}
+
+BookCheckpointWriter::Stats BookCheckpointWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string BookCheckpointWriter::pathFor(std::string_view symbol) const {
+    std::string name(symbol);
+    name += kSuffix;
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+// Encodes and writes one checkpoint per pass with the lock released; the
+// written checkpoint becomes its symbol's spare.
+void BookCheckpointWriter::run() {
+    std::string scratch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        auto next = slots_.end();
+        wake_.wait(lock, [this, &next]() {
+            for (next = slots_.begin(); next != slots_.end(); ++next) {
+                if (next->second.pending) {
+                    return true;
+                }
+            }
+            return stopping_;
+        });
+        if (next == slots_.end()) {
+            break;
+        }
+        BookCheckpoint checkpoint = std::move(*next->second.pending);
+        next->second.pending.reset();
+        lock.unlock();
+        const bool stored = checkpoint.store(pathFor(checkpoint.symbol), scratch);
+        lock.lock();
+
+        if (stored) {
+            ++stats_.written;
+        } else {
+            ++stats_.writeErrors;
+        }
+        next->second.spare = std::move(checkpoint);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "BookCheckpoint.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Writes BookCheckpoints to `SYMBOL.ckpt` files in one directory on a
+// background thread. Each symbol is double-buffered: the sync fills one
+// checkpoint while the other waits for or is being written, and submit()
+// trades them so the level vectors keep their capacity. A checkpoint still
+// waiting when the next one arrives is simply replaced.
+class BookCheckpointWriter {
+  public:
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t superseded = 0;
+        uint64_t writeErrors = 0;
+    };
+
+    // Null, after logging why, if the directory cannot be created.
+    static std::shared_ptr<BookCheckpointWriter> create(std::string directory);
+
+    BookCheckpointWriter(const BookCheckpointWriter&) = delete;
+    BookCheckpointWriter& operator=(const BookCheckpointWriter&) = delete;
+    // Closes the writer if close() was not called.
+    ~BookCheckpointWriter();
+
+    // Writes whatever is still queued and stops the thread. Idempotent.
+    void close();
+
+    // Queues `checkpoint` and returns a buffer to fill next time, empty or
+    // holding an older checkpoint. Thread-safe.
+    BookCheckpoint submit(BookCheckpoint checkpoint);
+    // The last checkpoint written for `symbol`, if any is readable.
+    std::optional<BookCheckpoint> load(std::string_view symbol) const;
+    Stats stats() const;
+
+  private:
+    struct Slot {
+        std::optional<BookCheckpoint> pending;
+        BookCheckpoint spare;
+    };
+
+    explicit BookCheckpointWriter(std::string directory);
+
+    std::string pathFor(std::string_view symbol) const;
+    void run();
+
+    const std::string directory_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::map<std::string, Slot, std::less<>> slots_;
+    bool stopping_ = false;
+    Stats stats_{};
+    std::thread writer_;
+};
@@ -0,0 +1,90 @@
+#include "BootstrapArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+bool BootstrapArena::append(const Event& event) {
+    if (event.raw.size() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    char* out = allocate(event.raw.size());
+    if (out == nullptr) {
+        return false;
+    }
+    std::memcpy(out, event.raw.data(), event.raw.size());
+    index_.push_back(Entry{
+        .firstUpdate = event.firstUpdate,
+        .lastUpdate = event.lastUpdate,
+        .previousLastUpdate = event.previousLastUpdate.value_or(0),
+        .receivedAt = event.receivedAt,
+        .chunk = static_cast<uint32_t>(current_),
+        .offset = static_cast<uint32_t>(used_ - event.raw.size()),
+        .size = static_cast<uint32_t>(event.raw.size()),
+        .hasPrevious = event.previousLastUpdate.has_value(),
+    });
+    return true;
+}
+
+void BootstrapArena::reset() {
+    index_.clear();
+    current_ = 0;
+    used_ = 0;
+    while (!chunks_.empty() && reservedBytes_ > options_.maxBytes) {
+        reservedBytes_ -= chunks_.back().bytes;
+        chunks_.pop_back();
+    }
+}
+
+void BootstrapArena::setMaxBytes(std::size_t maxBytes) {
+    options_.maxBytes = maxBytes;
+}
+
+BootstrapArena::Event BootstrapArena::operator[](std::size_t index) const {
+    const Entry& entry = index_[index];
+    return Event{
+        .firstUpdate = entry.firstUpdate,
+        .lastUpdate = entry.lastUpdate,
+        .previousLastUpdate =
+            entry.hasPrevious ? std::optional(entry.previousLastUpdate) : std::nullopt,
+        .raw = std::string_view(chunks_[entry.chunk].data.get() + entry.offset, entry.size),
+        .receivedAt = entry.receivedAt,
+    };
+}
+
+// Fills the current chunk, then any kept from earlier cycles that still
+// fit, before growing. Leaves `current_`/`used_` just past the allocation.
+char* BootstrapArena::allocate(std::size_t bytes) {
+    while (current_ < chunks_.size()) {
+        Chunk& chunk = chunks_[current_];
+        if (chunk.bytes - used_ >= bytes) {
+            char* out = chunk.data.get() + used_;
+            used_ += bytes;
+            return out;
+        }
+        if (used_ == 0) {
+            // Too small even empty; this and the chunks after it are unused
+            // this cycle, so give their share of the cap to one that fits.
+            while (chunks_.size() > current_) {
+                reservedBytes_ -= chunks_.back().bytes;
+                chunks_.pop_back();
+            }
+            break;
+        }
+        ++current_;
+        used_ = 0;
+    }
+
+    const std::size_t chunkBytes = std::max(options_.chunkBytes, bytes);
+    if (reservedBytes_ + chunkBytes > options_.maxBytes) {
+        return nullptr;
+    }
+    chunks_.push_back(Chunk{
+        .data = std::make_unique_for_overwrite<char[]>(chunkBytes),
+        .bytes = chunkBytes,
+    });
+    reservedBytes_ += chunkBytes;
+    current_ = chunks_.size() - 1;
+    used_ = bytes;
+    return chunks_.back().data.get();
+}
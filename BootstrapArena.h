@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Raw depth events held while a bootstrap waits for its snapshot. Payloads
+// are bump-allocated back to back into chunks, next to a compact index of
+// their [U, u, pu]; reset() rewinds both but keeps the memory, so later
+// resync cycles buffer without allocating. Chunk memory is capped at
+// `maxBytes`: an event that would need more is refused and the caller
+// decides what to drop. Not thread-safe; owned by one sync's strand.
+class BootstrapArena {
+  public:
+    struct Options {
+        std::size_t chunkBytes = 256 * 1024;
+        std::size_t maxBytes = 8 * 1024 * 1024;
+    };
+
+    struct Event {
+        uint64_t firstUpdate = 0;
+        uint64_t lastUpdate = 0;
+        std::optional<uint64_t> previousLastUpdate;
+        // Points into the arena until the next reset().
+        std::string_view raw;
+        std::chrono::steady_clock::time_point receivedAt{};
+    };
+
+    BootstrapArena()
+        : BootstrapArena(Options{}) {
+    }
+    explicit BootstrapArena(Options options)
+        : options_(options) {
+    }
+    BootstrapArena(const BootstrapArena&) = delete;
+    BootstrapArena& operator=(const BootstrapArena&) = delete;
+
+    // Copies `event.raw` in; false, storing nothing, past the cap.
+    bool append(const Event& event);
+    // Drops every event. Chunks are kept up to the cap, the rest released.
+    void reset();
+    // Applies at once: the next chunk allocation is checked against it.
+    // Events already held stay, and chunks beyond a lowered cap are only
+    // released by the next reset().
+    void setMaxBytes(std::size_t maxBytes);
+
+    Event operator[](std::size_t index) const;
+    std::size_t size() const {
+        return index_.size();
+    }
+    bool empty() const {
+        return index_.empty();
+    }
+    // Chunk memory currently held, used or not.
+    std::size_t reservedBytes() const {
+        return reservedBytes_;
+    }
+
+  private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        std::size_t bytes = 0;
+    };
+    struct Entry {
+        uint64_t firstUpdate;
+        uint64_t lastUpdate;
+        uint64_t previousLastUpdate;
+        std::chrono::steady_clock::time_point receivedAt;
+        uint32_t chunk;
+        uint32_t offset;
+        uint32_t size;
+        bool hasPrevious;
+    };
+
+    char* allocate(std::size_t bytes);
+
+    Options options_;
+    std::vector<Chunk> chunks_;
+    std::vector<Entry> index_;
+    std::size_t current_ = 0;
+    std::size_t used_ = 0;
+    std::size_t reservedBytes_ = 0;
+};
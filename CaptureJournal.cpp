@@ -0,0 +1,262 @@
+#include "CaptureJournal.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <system_error>
+
+namespace {
+constexpr std::string_view kSegmentPrefix = "journal-";
+constexpr std::string_view kSegmentSuffix = ".bin";
+constexpr std::size_t kMinRingBytes = 64 * 1024;
+
+std::size_t alignUp(std::size_t bytes) {
+    return (bytes + CaptureJournal::kAlignment - 1) & ~(CaptureJournal::kAlignment - 1);
+}
+} // namespace
+
+std::shared_ptr<CaptureJournal> CaptureJournal::create(Options options) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(options.directory, ec);
+    if (ec) {
+        std::cerr << "CaptureJournal cannot create " << options.directory << ": " << ec.message()
+                  << '\n';
+        return nullptr;
+    }
+
+    uint64_t firstSegment = 0;
+    for (const auto& entry : fs::directory_iterator(options.directory, ec)) {
+        if (const auto index = segmentIndex(entry.path().filename().string())) {
+            firstSegment = std::max(firstSegment, *index + 1);
+        }
+    }
+    if (ec) {
+        std::cerr << "CaptureJournal cannot list " << options.directory << ": " << ec.message()
+                  << '\n';
+        return nullptr;
+    }
+    return std::shared_ptr<CaptureJournal>(new CaptureJournal(std::move(options), firstSegment));
+}
+
+CaptureJournal::CaptureJournal(Options options, uint64_t firstSegment)
+    : options_(std::move(options)),
+      capacity_(std::max(kMinRingBytes, options_.ringBytes & ~(kAlignment - 1))),
+      ring_(std::make_unique_for_overwrite<char[]>(capacity_)),
+      nextSegment_(firstSegment) {
+    writer_ = std::thread([this]() { run(); });
+}
+
+CaptureJournal::~CaptureJournal() {
+    close();
+}
+
+void CaptureJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void CaptureJournal::record(RecordType type, std::string_view symbol, std::string_view payload) {
+    const std::size_t bytes = recordBytes(symbol.size(), payload.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Stamped under the lock so the journal is in receive-time order.
+    const uint64_t receivedNs = nowNs();
+    if (stopping_ || symbol.size() > std::numeric_limits<uint16_t>::max() ||
+        payload.size() > std::numeric_limits<uint32_t>::max()) {
+        ++stats_.droppedRecords;
+        return;
+    }
+
+    const bool wasEmpty = head_ == tail_;
+    char* out = nullptr;
+    if (tail_ >= head_) {
+        if (capacity_ - tail_ >= bytes) {
+            out = ring_.get() + tail_;
+            tail_ += bytes;
+        } else if (head_ > bytes) {
+            wrapEnd_ = tail_;
+            out = ring_.get();
+            tail_ = bytes;
+        }
+    } else if (head_ - tail_ > bytes) {
+        out = ring_.get() + tail_;
+        tail_ += bytes;
+    }
+    if (out == nullptr) {
+        ++stats_.droppedRecords;
+        return;
+    }
+
+    const RecordHeader header{
+        .payloadBytes = static_cast<uint32_t>(payload.size()),
+        .type = static_cast<uint16_t>(type),
+        .symbolBytes = static_cast<uint16_t>(symbol.size()),
+        .receivedNs = receivedNs,
+    };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, symbol.data(), symbol.size());
+    out += symbol.size();
+    std::memcpy(out, payload.data(), payload.size());
+    out += payload.size();
+    std::memset(out, 0, bytes - sizeof(header) - symbol.size() - payload.size());
+
+    if (wasEmpty) {
+        wake_.notify_one();
+    }
+}
+
+CaptureJournal::Stats CaptureJournal::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+uint64_t CaptureJournal::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+std::size_t CaptureJournal::recordBytes(std::size_t symbolBytes, std::size_t payloadBytes) {
+    return alignUp(sizeof(RecordHeader) + symbolBytes + payloadBytes);
+}
+
+std::string CaptureJournal::segmentName(uint64_t index) {
+    return std::format("{}{:06}{}", kSegmentPrefix, index, kSegmentSuffix);
+}
+
+std::optional<uint64_t> CaptureJournal::segmentIndex(std::string_view name) {
+    if (!name.starts_with(kSegmentPrefix) || !name.ends_with(kSegmentSuffix)) {
+        return std::nullopt;
+    }
+    name.remove_prefix(kSegmentPrefix.size());
+    name.remove_suffix(kSegmentSuffix.size());
+    uint64_t index = 0;
+    const auto [end, ec] = std::from_chars(name.data(), name.data() + name.size(), index);
+    if (ec != std::errc{} || end != name.data() + name.size()) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+// Drains one contiguous stretch of the ring per pass; producers keep
+// appending behind it meanwhile.
+void CaptureJournal::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this]() { return stopping_ || head_ != tail_; });
+        if (head_ == tail_) {
+            break;
+        }
+        const std::size_t begin = head_;
+        const std::size_t end = tail_ >= head_ ? tail_ : wrapEnd_;
+        lock.unlock();
+        writeRecords(ring_.get() + begin, end - begin);
+        lock.lock();
+
+        head_ = end;
+        if (tail_ < head_ && head_ == wrapEnd_) {
+            head_ = 0;
+        }
+        if (head_ == tail_) {
+            head_ = 0;
+            tail_ = 0;
+        }
+    }
+    lock.unlock();
+    closeSegment();
+}
+
+void CaptureJournal::writeRecords(const char* data, std::size_t bytes) {
+    uint64_t records = 0;
+    uint64_t written = 0;
+    uint64_t segments = 0;
+    uint64_t errors = 0;
+
+    std::size_t offset = 0;
+    while (offset < bytes) {
+        if (segment_ == nullptr) {
+            if (!openSegment()) {
+                ++errors;
+                break;
+            }
+            ++segments;
+        }
+        // Whole records that still fit this segment; a record larger than
+        // a segment gets a fresh one to itself.
+        std::size_t run = 0;
+        uint64_t runRecords = 0;
+        while (offset + run < bytes) {
+            RecordHeader header;
+            std::memcpy(&header, data + offset + run, sizeof(header));
+            const std::size_t size = recordBytes(header.symbolBytes, header.payloadBytes);
+            const bool fresh = run == 0 && segmentUsed_ == sizeof(SegmentHeader);
+            if (segmentUsed_ + run + size > options_.segmentBytes && !fresh) {
+                break;
+            }
+            run += size;
+            ++runRecords;
+        }
+        if (run == 0) {
+            closeSegment();
+            continue;
+        }
+        if (std::fwrite(data + offset, 1, run, segment_) != run) {
+            ++errors;
+            closeSegment();
+            break;
+        }
+        segmentUsed_ += run;
+        offset += run;
+        records += runRecords;
+        written += run;
+    }
+    if (segment_ != nullptr) {
+        std::fflush(segment_);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.records += records;
+    stats_.bytes += written;
+    stats_.segments += segments;
+    stats_.writeErrors += errors;
+}
+
+bool CaptureJournal::openSegment() {
+    const auto path = std::filesystem::path(options_.directory) / segmentName(nextSegment_++);
+    segment_ = std::fopen(path.string().c_str(), "wb");
+    if (segment_ == nullptr) {
+        std::cerr << "CaptureJournal cannot open " << path.string() << '\n';
+        return false;
+    }
+    SegmentHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.headerBytes = sizeof(SegmentHeader);
+    header.createdNs = nowNs();
+    if (std::fwrite(&header, sizeof(header), 1, segment_) != 1) {
+        closeSegment();
+        return false;
+    }
+    segmentUsed_ = sizeof(header);
+    return true;
+}
+
+void CaptureJournal::closeSegment() {
+    if (segment_ != nullptr) {
+        std::fclose(segment_);
+        segment_ = nullptr;
+    }
+    segmentUsed_ = 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Append-only capture of everything the engine received: raw stream frames
+// and snapshot bodies, each tagged with its symbol and a nanosecond receive
+// time. record() only copies into an in-memory ring; a background thread
+// drains the ring into segment files. A full ring drops the record rather
+// than stall the caller.
+//
+// Segments are `journal-NNNNNN.bin` in one directory, numbered on from any
+// already there. Each starts with a SegmentHeader followed by records, all
+// little-endian and 8-byte aligned so a mapped segment can be walked in
+// place: RecordHeader, symbol bytes, payload bytes, zero padding. A record
+// never spans segments.
+class CaptureJournal {
+  public:
+    enum class RecordType : uint16_t {
+        StreamFrame = 1,
+        Snapshot = 2,
+    };
+
+    struct SegmentHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerBytes;
+        uint64_t createdNs;
+    };
+
+    struct RecordHeader {
+        uint32_t payloadBytes;
+        uint16_t type;
+        uint16_t symbolBytes;
+        // Wall clock, nanoseconds since the Unix epoch.
+        uint64_t receivedNs;
+    };
+
+    struct Options {
+        std::string directory;
+        std::size_t segmentBytes = 256 * 1024 * 1024;
+        std::size_t ringBytes = 64 * 1024 * 1024;
+    };
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t droppedRecords = 0;
+        uint64_t segments = 0;
+        uint64_t writeErrors = 0;
+    };
+
+    static constexpr char kMagic[8] = {'O', 'B', 'J', 'R', 'N', 'L', '\0', '\0'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr std::size_t kAlignment = 8;
+
+    // Null, after logging why, if the directory cannot be created.
+    static std::shared_ptr<CaptureJournal> create(Options options);
+
+    CaptureJournal(const CaptureJournal&) = delete;
+    CaptureJournal& operator=(const CaptureJournal&) = delete;
+    // Closes the journal if close() was not called.
+    ~CaptureJournal();
+
+    // Writes out whatever is still in the ring and stops the writer; later
+    // records are dropped. Idempotent.
+    void close();
+
+    // Thread-safe; stamps the record with the current time.
+    void record(RecordType type, std::string_view symbol, std::string_view payload);
+    Stats stats() const;
+
+    static uint64_t nowNs();
+    static std::size_t recordBytes(std::size_t symbolBytes, std::size_t payloadBytes);
+    static std::string segmentName(uint64_t index);
+    // Inverse of segmentName(); nullopt for any other file name.
+    static std::optional<uint64_t> segmentIndex(std::string_view fileName);
+
+  private:
+    explicit CaptureJournal(Options options, uint64_t firstSegment);
+
+    void run();
+    void writeRecords(const char* data, std::size_t bytes);
+    bool openSegment();
+    void closeSegment();
+
+    const Options options_;
+    const std::size_t capacity_;
+    const std::unique_ptr<char[]> ring_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    // Readable bytes are [head_, tail_), or [head_, wrapEnd_) then
+    // [0, tail_) once the writer side has wrapped.
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+    std::size_t wrapEnd_ = 0;
+    bool stopping_ = false;
+    Stats stats_{};
+
+    // Writer thread only.
+    std::FILE* segment_ = nullptr;
+    std::size_t segmentUsed_ = 0;
+    uint64_t nextSegment_ = 0;
+
+    std::thread writer_;
+};
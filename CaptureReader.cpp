@@ -0,0 +1,154 @@
+#include "CaptureReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+bool knownType(uint16_t type) {
+    return type == static_cast<uint16_t>(CaptureJournal::RecordType::StreamFrame) ||
+           type == static_cast<uint16_t>(CaptureJournal::RecordType::Snapshot);
+}
+} // namespace
+
+std::unique_ptr<CaptureReader> CaptureReader::open(const std::string& directory) {
+    namespace fs = std::filesystem;
+    std::vector<std::pair<uint64_t, std::string>> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (const auto index = CaptureJournal::segmentIndex(entry.path().filename().string())) {
+            paths.emplace_back(*index, entry.path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "CaptureReader cannot list " << directory << ": " << ec.message() << '\n';
+        return nullptr;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::unique_ptr<CaptureReader> reader(new CaptureReader());
+    for (const auto& [index, path] : paths) {
+        auto segment = load(path);
+        if (!segment) {
+            std::cerr << "CaptureReader skipping unreadable segment " << path << '\n';
+            continue;
+        }
+        reader->segments_.push_back(std::move(*segment));
+    }
+    if (reader->segments_.empty()) {
+        std::cerr << "CaptureReader found no journal segments in " << directory << '\n';
+        return nullptr;
+    }
+    reader->rewind();
+    return reader;
+}
+
+CaptureReader::~CaptureReader() {
+#if defined(__linux__)
+    for (const auto& segment : segments_) {
+        if (segment.mapped) {
+            ::munmap(const_cast<char*>(segment.data), segment.bytes);
+        }
+    }
+#endif
+}
+
+std::optional<CaptureReader::Record> CaptureReader::next() {
+    while (segment_ < segments_.size()) {
+        const Segment& segment = segments_[segment_];
+        const std::size_t left = segment.bytes - offset_;
+        CaptureJournal::RecordHeader header{};
+        if (left >= sizeof(header)) {
+            std::memcpy(&header, segment.data + offset_, sizeof(header));
+        }
+        const std::size_t size =
+            CaptureJournal::recordBytes(header.symbolBytes, header.payloadBytes);
+        if (left < sizeof(header) || size > left || !knownType(header.type)) {
+            if (left != 0) {
+                ++truncatedSegments_;
+            }
+            ++segment_;
+            offset_ = sizeof(CaptureJournal::SegmentHeader);
+            continue;
+        }
+
+        const char* body = segment.data + offset_ + sizeof(header);
+        offset_ += size;
+        return Record{
+            .type = static_cast<CaptureJournal::RecordType>(header.type),
+            .symbol = std::string_view(body, header.symbolBytes),
+            .payload = std::string_view(body + header.symbolBytes, header.payloadBytes),
+            .receivedNs = header.receivedNs,
+        };
+    }
+    return std::nullopt;
+}
+
+void CaptureReader::rewind() {
+    segment_ = 0;
+    offset_ = sizeof(CaptureJournal::SegmentHeader);
+    truncatedSegments_ = 0;
+}
+
+// Maps the whole file and checks its header; the record area may be empty.
+std::optional<CaptureReader::Segment> CaptureReader::load(const std::string& path) {
+    Segment segment;
+#if defined(__linux__)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    segment.bytes = static_cast<std::size_t>(info.st_size);
+    void* memory = ::mmap(nullptr, segment.bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return std::nullopt;
+    }
+    ::madvise(memory, segment.bytes, MADV_SEQUENTIAL);
+    segment.data = static_cast<const char*>(memory);
+    segment.mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return std::nullopt;
+    }
+    segment.bytes = static_cast<std::size_t>(in.tellg());
+    segment.copy = std::make_unique_for_overwrite<char[]>(segment.bytes);
+    in.seekg(0);
+    if (!in.read(segment.copy.get(), static_cast<std::streamsize>(segment.bytes))) {
+        return std::nullopt;
+    }
+    segment.data = segment.copy.get();
+#endif
+
+    CaptureJournal::SegmentHeader header{};
+    bool valid = segment.bytes >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, segment.data, sizeof(header));
+        valid = std::memcmp(header.magic, CaptureJournal::kMagic, sizeof(header.magic)) == 0 &&
+                header.version == CaptureJournal::kVersion && header.headerBytes == sizeof(header);
+    }
+    if (!valid) {
+#if defined(__linux__)
+        ::munmap(const_cast<char*>(segment.data), segment.bytes);
+#endif
+        return std::nullopt;
+    }
+    return segment;
+}
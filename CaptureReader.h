@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CaptureJournal.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Walks the records of a CaptureJournal directory in journal order,
+// reading each segment through a read-only memory map. A record that does
+// not fit its segment (a capture cut short) ends that segment.
+class CaptureReader {
+  public:
+    struct Record {
+        CaptureJournal::RecordType type = CaptureJournal::RecordType::StreamFrame;
+        // Both point into the mapped segment and stay valid while the reader
+        // lives.
+        std::string_view symbol;
+        std::string_view payload;
+        uint64_t receivedNs = 0;
+    };
+
+    // Null, after logging why, if the directory holds no readable segment.
+    static std::unique_ptr<CaptureReader> open(const std::string& directory);
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    ~CaptureReader();
+
+    std::optional<Record> next();
+    void rewind();
+
+    std::size_t segments() const {
+        return segments_.size();
+    }
+    // Segments whose tail was cut short or held an unknown record.
+    uint64_t truncatedSegments() const {
+        return truncatedSegments_;
+    }
+
+  private:
+    struct Segment {
+        const char* data = nullptr;
+        std::size_t bytes = 0;
+        bool mapped = false;
+        // Fallback where memory maps are unavailable.
+        std::unique_ptr<char[]> copy;
+    };
+
+    CaptureReader() = default;
+    static std::optional<Segment> load(const std::string& path);
+
+    std::vector<Segment> segments_;
+    std::size_t segment_ = 0;
+    std::size_t offset_ = 0;
+    uint64_t truncatedSegments_ = 0;
+};
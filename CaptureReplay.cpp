@@ -0,0 +1,292 @@
+#include "CaptureReplay.h"
+
+#include "BinanceAPIParser.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <optional>
+#include <utility>
+
+class CaptureReplay::LiveFeed : public ILiveMarketData {
+  public:
+    void start(std::string_view symbol, OnText onText) override final {
+        startFrames(symbol, [onText = std::move(onText)](FrameRef frame) {
+            onText(std::string(frame.text()));
+        });
+    }
+
+    // The feed is bound to its symbol; the argument is ignored.
+    void startFrames(std::string_view, OnFrame onFrame) override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onFrame_ = std::move(onFrame);
+    }
+
+    void stop() override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onFrame_ = nullptr;
+    }
+
+    bool deliver(const FrameRef& frame) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!onFrame_) {
+            return false;
+        }
+        onFrame_(frame);
+        return true;
+    }
+
+  private:
+    std::mutex mutex_;
+    OnFrame onFrame_;
+};
+
+class CaptureReplay::SnapshotFeed : public ISnapshotSource {
+  public:
+    explicit SnapshotFeed(SymbolScales scales)
+        : scales_(scales) {
+    }
+
+    void getSnapshotAsync(OnSnapshot onSnapshot) override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = std::move(onSnapshot);
+    }
+
+    void setOnRawSnapshot(OnRawSnapshot onRawSnapshot) override final {
+        std::lock_guard<std::mutex> lock(mutex_);
+        onRawSnapshot_ = std::move(onRawSnapshot);
+    }
+
+    void setScales(SymbolScales scales) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scales_ = scales;
+    }
+
+    // Pairs `body` with the outstanding request, if any, to be answered
+    // after `delayFrames` more frames.
+    bool match(std::string_view body, std::size_t delayFrames) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pending_ || held_) {
+                return false;
+            }
+            held_ = body;
+            holdFrames_ = delayFrames;
+        }
+        if (delayFrames == 0) {
+            release();
+        }
+        return true;
+    }
+
+    void onFrame() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!held_ || holdFrames_ == 0 || --holdFrames_ != 0) {
+                return;
+            }
+        }
+        release();
+    }
+
+    // Answers the request with the held body.
+    void release() {
+        OnSnapshot onSnapshot;
+        OnRawSnapshot onRawSnapshot;
+        std::string_view body;
+        SymbolScales scales{};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!held_) {
+                return;
+            }
+            body = *held_;
+            held_.reset();
+            onSnapshot = std::exchange(pending_, nullptr);
+            onRawSnapshot = onRawSnapshot_;
+            scales = scales_;
+        }
+        auto snapshot = BinanceAPIParser{scales}.parseSnapshot(body);
+        if (onRawSnapshot) {
+            onRawSnapshot(body);
+        }
+        if (snapshot.lastUpdate == 0) {
+            onSnapshot(std::nullopt);
+            return;
+        }
+        onSnapshot(std::move(snapshot));
+    }
+
+  private:
+    std::mutex mutex_;
+    SymbolScales scales_{};
+    OnSnapshot pending_;
+    OnRawSnapshot onRawSnapshot_;
+    std::optional<std::string_view> held_;
+    std::size_t holdFrames_ = 0;
+};
+
+CaptureReplay::CaptureReplay(boost::asio::io_context& ioContext,
+                             std::unique_ptr<CaptureReader> reader, Pace pace, Faults faults)
+    : strand_(boost::asio::make_strand(ioContext)),
+      timer_(strand_),
+      reader_(std::move(reader)),
+      pace_(pace),
+      faults_(faults),
+      random_(faults.seed),
+      drop_(faults.dropProbability),
+      duplicate_(faults.duplicateProbability) {
+}
+
+CaptureReplay::~CaptureReplay() = default;
+
+ILiveMarketData& CaptureReplay::liveMarketData(std::string_view symbol) {
+    return *symbolEntry(symbol).live;
+}
+
+ISnapshotSource& CaptureReplay::snapshotSource(std::string_view symbol, SymbolScales scales) {
+    auto& snapshots = *symbolEntry(symbol).snapshots;
+    snapshots.setScales(scales);
+    return snapshots;
+}
+
+CaptureReplay::Symbol& CaptureReplay::symbolEntry(std::string_view symbol) {
+    auto [it, inserted] = symbols_.try_emplace(std::string(symbol));
+    if (inserted) {
+        it->second.live = std::make_unique<LiveFeed>();
+        it->second.snapshots = std::make_unique<SnapshotFeed>(SymbolScales{});
+    }
+    return it->second;
+}
+
+void CaptureReplay::start(OnFinished onFinished) {
+    boost::asio::post(strand_, [this, onFinished = std::move(onFinished)]() mutable {
+        onFinished_ = std::move(onFinished);
+        reader_->rewind();
+        random_.seed(faults_.seed);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_ = {};
+        }
+        running_ = true;
+        firstRecordNs_ = 0;
+        startedAt_ = std::chrono::steady_clock::now();
+        advance();
+    });
+}
+
+void CaptureReplay::stop() {
+    boost::asio::post(strand_, [this]() {
+        running_ = false;
+        timer_.cancel();
+    });
+}
+
+CaptureReplay::Stats CaptureReplay::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+// Plays one record per handler. Going back through the executor each time
+// lets whatever the previous record triggered run first.
+void CaptureReplay::advance() {
+    if (!running_) {
+        return;
+    }
+    auto record = reader_->next();
+    if (!record) {
+        finish();
+        return;
+    }
+    if (pace_ == Pace::MaxSpeed) {
+        deliver(*record);
+        boost::asio::post(strand_, [this]() { advance(); });
+        return;
+    }
+
+    if (firstRecordNs_ == 0) {
+        firstRecordNs_ = record->receivedNs;
+    }
+    const auto offset = std::chrono::nanoseconds(
+        record->receivedNs > firstRecordNs_ ? record->receivedNs - firstRecordNs_ : 0);
+    timer_.expires_at(startedAt_ + offset);
+    timer_.async_wait([this, record = *record](const boost::system::error_code& ec) {
+        if (ec || !running_) {
+            return;
+        }
+        deliver(record);
+        advance();
+    });
+}
+
+void CaptureReplay::deliver(const CaptureReader::Record& record) {
+    if (record.type == CaptureJournal::RecordType::StreamFrame) {
+        deliverFrame(record);
+    } else {
+        deliverSnapshot(record);
+    }
+}
+
+void CaptureReplay::deliverFrame(const CaptureReader::Record& record) {
+    const auto it = symbols_.find(std::string(record.symbol));
+    if (it == symbols_.end()) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.unusedRecords;
+        return;
+    }
+    const bool dropped = faults_.dropProbability > 0.0 && drop_(random_);
+    const bool duplicated =
+        !dropped && faults_.duplicateProbability > 0.0 && duplicate_(random_);
+    bool delivered = false;
+    if (!dropped) {
+        const FrameRef frame = framePool_->copy(record.payload);
+        delivered = it->second.live->deliver(frame);
+        if (duplicated) {
+            it->second.live->deliver(frame);
+        }
+    }
+    it->second.snapshots->onFrame();
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    if (dropped) {
+        ++stats_.droppedFrames;
+    } else if (!delivered) {
+        ++stats_.unusedRecords;
+    } else {
+        ++stats_.frames;
+        stats_.duplicatedFrames += duplicated ? 1 : 0;
+    }
+}
+
+void CaptureReplay::deliverSnapshot(const CaptureReader::Record& record) {
+    const auto it = symbols_.find(std::string(record.symbol));
+    const bool matched = it != symbols_.end() &&
+                         it->second.snapshots->match(record.payload, faults_.snapshotDelayFrames);
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    if (matched) {
+        ++stats_.snapshots;
+    } else {
+        ++stats_.unusedRecords;
+    }
+}
+
+// Snapshots still held for a delay are answered; the capture has no frames
+// left to wait for.
+void CaptureReplay::finish() {
+    running_ = false;
+    for (auto& [symbol, entry] : symbols_) {
+        entry.snapshots->release();
+    }
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - startedAt_)
+                .count());
+        stats_.finished = true;
+        stats = stats_;
+    }
+    if (onFinished_) {
+        onFinished_(stats);
+    }
+}
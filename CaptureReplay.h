@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CaptureReader.h"
+#include "FrameBuffer.h"
+#include "ILiveMarketData.h"
+#include "ISnapshotSource.h"
+#include "Types.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Plays a capture back through per-symbol ILiveMarketData and
+// ISnapshotSource views, so BinanceOrderBookSync runs unchanged against
+// recorded data. One driver walks the journal in order and hands each frame
+// to its symbol the way a live feed would. A snapshot request is answered
+// by the next snapshot recorded for that symbol after it, which is how the
+// capture paired them.
+//
+// With a single-threaded io_context, runs over the same capture with the
+// same faults are identical. MaxSpeed plays the next record as soon as the
+// handlers queued by the previous one have run; RealTime keeps the
+// recorded spacing.
+class CaptureReplay {
+  public:
+    enum class Pace {
+        MaxSpeed,
+        RealTime,
+    };
+
+    // Injected on demand, reproducibly for a given seed.
+    struct Faults {
+        // Per frame: dropped (a gap) or delivered twice.
+        double dropProbability = 0.0;
+        double duplicateProbability = 0.0;
+        // A matched snapshot is held back for this many further frames.
+        std::size_t snapshotDelayFrames = 0;
+        uint64_t seed = 1;
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t snapshots = 0;
+        uint64_t droppedFrames = 0;
+        uint64_t duplicatedFrames = 0;
+        // Records for symbols nobody listens to, or snapshots nobody asked for.
+        uint64_t unusedRecords = 0;
+        uint64_t elapsedNs = 0;
+        bool finished = false;
+    };
+
+    using OnFinished = std::function<void(const Stats&)>;
+
+    CaptureReplay(boost::asio::io_context& ioContext, std::unique_ptr<CaptureReader> reader)
+        : CaptureReplay(ioContext, std::move(reader), Pace::MaxSpeed, Faults{}) {
+    }
+    CaptureReplay(boost::asio::io_context& ioContext, std::unique_ptr<CaptureReader> reader,
+                  Pace pace, Faults faults);
+    CaptureReplay(const CaptureReplay&) = delete;
+    CaptureReplay& operator=(const CaptureReplay&) = delete;
+    ~CaptureReplay();
+
+    // Views for `symbol`, created on first use; take them before start().
+    // Recorded snapshots are parsed with `scales`.
+    ILiveMarketData& liveMarketData(std::string_view symbol);
+    ISnapshotSource& snapshotSource(std::string_view symbol, SymbolScales scales);
+
+    void start(OnFinished onFinished = {});
+    void stop();
+    Stats stats() const;
+
+  private:
+    class LiveFeed;
+    class SnapshotFeed;
+    struct Symbol {
+        std::unique_ptr<LiveFeed> live;
+        std::unique_ptr<SnapshotFeed> snapshots;
+    };
+
+    Symbol& symbolEntry(std::string_view symbol);
+    void advance();
+    void deliver(const CaptureReader::Record& record);
+    void deliverFrame(const CaptureReader::Record& record);
+    void deliverSnapshot(const CaptureReader::Record& record);
+    void finish();
+
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    boost::asio::steady_timer timer_;
+    const std::unique_ptr<CaptureReader> reader_;
+    const Pace pace_;
+    const Faults faults_;
+    std::mt19937_64 random_;
+    std::bernoulli_distribution drop_;
+    std::bernoulli_distribution duplicate_;
+    const std::shared_ptr<FrameBufferPool> framePool_ = FrameBufferPool::create();
+    std::unordered_map<std::string, Symbol> symbols_;
+    OnFinished onFinished_;
+    bool running_ = false;
+    uint64_t firstRecordNs_ = 0;
+    std::chrono::steady_clock::time_point startedAt_{};
+    mutable std::mutex statsMutex_;
+    Stats stats_{};
+};
@@ -0,0 +1,151 @@
+#include "ExchangeClock.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/json.hpp>
+#include <boost/system/error_code.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+constexpr std::string_view kTimeTarget = "/fapi/v1/time";
+
+int64_t epochUs(std::chrono::system_clock::time_point at) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(at.time_since_epoch()).count();
+}
+} // namespace
+
+std::shared_ptr<ExchangeClock> ExchangeClock::create(std::shared_ptr<HttpsClient> client,
+                                                     Options options) {
+    return std::shared_ptr<ExchangeClock>(new ExchangeClock(std::move(client), options));
+}
+
+ExchangeClock::ExchangeClock(std::shared_ptr<HttpsClient> client, Options options)
+    : client_(std::move(client)), options_(options), timer_(client_->executor()) {
+}
+
+void ExchangeClock::start() {
+    boost::asio::post(client_->executor(), [self = shared_from_this()]() {
+        if (!self->stopped_) {
+            return;
+        }
+        self->stopped_ = false;
+        ++self->generation_;
+        self->startRound();
+    });
+}
+
+void ExchangeClock::stop() {
+    boost::asio::post(client_->executor(), [self = shared_from_this()]() {
+        self->stopped_ = true;
+        self->timer_.cancel();
+    });
+}
+
+std::optional<int64_t> ExchangeClock::offsetUs() const {
+    if (!hasOffset_.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    return offsetUs_.load(std::memory_order_relaxed);
+}
+
+std::optional<ExchangeClock::Estimate> ExchangeClock::estimate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return estimate_;
+}
+
+std::optional<int64_t> ExchangeClock::toExchangeUs(std::chrono::system_clock::time_point at) const {
+    const auto offset = offsetUs();
+    if (!offset) {
+        return std::nullopt;
+    }
+    return epochUs(at) + *offset;
+}
+
+std::optional<uint64_t> ExchangeClock::parseServerTime(std::string_view body) {
+    boost::system::error_code ec;
+    const auto parsed = boost::json::parse(body, ec);
+    if (ec || !parsed.is_object()) {
+        return std::nullopt;
+    }
+    const auto* serverTime = parsed.as_object().if_contains("serverTime");
+    if (!serverTime) {
+        return std::nullopt;
+    }
+    if (serverTime->is_uint64()) {
+        return serverTime->as_uint64();
+    }
+    if (serverTime->is_int64() && serverTime->as_int64() > 0) {
+        return static_cast<uint64_t>(serverTime->as_int64());
+    }
+    return std::nullopt;
+}
+
+void ExchangeClock::startRound() {
+    samplesTaken_ = 0;
+    best_.reset();
+    sample(generation_);
+}
+
+// Samples go out one at a time so they do not queue behind each other on
+// the client's connections and inflate each other's round trips.
+void ExchangeClock::sample(uint64_t generation) {
+    if (stopped_ || generation != generation_) {
+        return;
+    }
+    if (samplesTaken_ == options_.samplesPerRound) {
+        finishRound();
+        return;
+    }
+    ++samplesTaken_;
+    // The round trip comes from the steady clock so a wall-clock step
+    // mid-sample cannot skew it.
+    const auto sentAt = std::chrono::system_clock::now();
+    const auto sentSteady = std::chrono::steady_clock::now();
+    client_->get(std::string(kTimeTarget), [self = shared_from_this(), generation, sentAt,
+                                            sentSteady](std::optional<HttpsClient::Response> response) {
+        const auto roundTripUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - sentSteady)
+                                     .count();
+        const auto serverTime = response && response->status == 200
+                                    ? parseServerTime(response->body)
+                                    : std::nullopt;
+        if (!serverTime) {
+            ++self->failedSamples_;
+            self->sample(generation);
+            return;
+        }
+        if (!self->best_ || static_cast<uint64_t>(roundTripUs) < self->best_->roundTripUs) {
+            const int64_t midpointUs = epochUs(sentAt) + roundTripUs / 2;
+            // serverTime is truncated to the millisecond; take the middle of it.
+            const int64_t serverUs = static_cast<int64_t>(*serverTime) * 1000 + 500;
+            self->best_ = Estimate{
+                .offsetUs = serverUs - midpointUs,
+                .roundTripUs = static_cast<uint64_t>(roundTripUs),
+            };
+        }
+        self->sample(generation);
+    });
+}
+
+void ExchangeClock::finishRound() {
+    if (best_) {
+        ++rounds_;
+        best_->rounds = rounds_;
+        best_->failedSamples = failedSamples_;
+        offsetUs_.store(best_->offsetUs, std::memory_order_relaxed);
+        hasOffset_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex_);
+        estimate_ = best_;
+    } else {
+        std::cerr << "ExchangeClock got no server time this round\n";
+    }
+
+    timer_.expires_after(options_.interval);
+    timer_.async_wait([self = shared_from_this(),
+                       generation = generation_](const boost::system::error_code& ec) {
+        if (!ec && generation == self->generation_ && !self->stopped_) {
+            self->startRound();
+        }
+    });
+}
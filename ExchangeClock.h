@@ -0,0 +1,81 @@
+#pragma once
+
+#include "HttpsClient.h"
+
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+// Estimates how far the exchange clock is ahead of the local wall clock from
+// `/fapi/v1/time` round trips, NTP style: each sample assumes the server
+// stamped its reply halfway through the round trip, and every round keeps
+// the sample with the shortest round trip, whose error is bounded by half
+// of it. Rounds repeat every `interval` to follow drift. Thread-safe reads.
+class ExchangeClock : public std::enable_shared_from_this<ExchangeClock> {
+  public:
+    struct Options {
+        std::size_t samplesPerRound = 8;
+        std::chrono::milliseconds interval{60000};
+    };
+
+    struct Estimate {
+        // Exchange time minus local time.
+        int64_t offsetUs = 0;
+        // Round trip of the sample the offset came from; the offset is
+        // within half of it.
+        uint64_t roundTripUs = 0;
+        uint64_t rounds = 0;
+        uint64_t failedSamples = 0;
+    };
+
+    static std::shared_ptr<ExchangeClock> create(std::shared_ptr<HttpsClient> client,
+                                                 Options options);
+    static std::shared_ptr<ExchangeClock> create(std::shared_ptr<HttpsClient> client) {
+        return create(std::move(client), Options{});
+    }
+    ExchangeClock(const ExchangeClock&) = delete;
+    ExchangeClock& operator=(const ExchangeClock&) = delete;
+
+    void start();
+    void stop();
+
+    // nullopt until the first round completes.
+    std::optional<int64_t> offsetUs() const;
+    std::optional<Estimate> estimate() const;
+    // Local wall-clock time `at` on the exchange clock, in epoch
+    // microseconds; nullopt until the first round completes.
+    std::optional<int64_t> toExchangeUs(std::chrono::system_clock::time_point at) const;
+
+    static std::optional<uint64_t> parseServerTime(std::string_view body);
+
+  private:
+    ExchangeClock(std::shared_ptr<HttpsClient> client, Options options);
+
+    void startRound();
+    void sample(uint64_t generation);
+    void finishRound();
+
+    std::shared_ptr<HttpsClient> client_;
+    const Options options_;
+    boost::asio::steady_timer timer_;
+
+    // Client strand only.
+    bool stopped_ = true;
+    // Bumped per start() so replies from before a stop() are ignored.
+    uint64_t generation_ = 0;
+    std::size_t samplesTaken_ = 0;
+    std::optional<Estimate> best_;
+    uint64_t rounds_ = 0;
+    uint64_t failedSamples_ = 0;
+
+    std::atomic<bool> hasOffset_{false};
+    std::atomic<int64_t> offsetUs_{0};
+    mutable std::mutex mutex_;
+    std::optional<Estimate> estimate_;
+};
@@ -0,0 +1,141 @@
+#include "FeedArbiter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace {
+uint64_t parseId(std::string_view payload, std::string_view key) {
+    const auto at = payload.find(key);
+    if (at == std::string_view::npos) {
+        return 0;
+    }
+    const char* begin = payload.data() + at + key.size();
+    uint64_t id = 0;
+    std::from_chars(begin, payload.data() + payload.size(), id);
+    return id;
+}
+} // namespace
+
+FeedArbiter::FeedStats& FeedArbiter::FeedStats::operator+=(const FeedStats& other) {
+    frames += other.frames;
+    wins += other.wins;
+    duplicates += other.duplicates;
+    held += other.held;
+    lagSamples += other.lagSamples;
+    totalLagUs += other.totalLagUs;
+    maxLagUs = std::max(maxLagUs, other.maxLagUs);
+    return *this;
+}
+
+FeedArbiter::FeedArbiter(std::size_t feeds)
+    : feeds_(feeds) {
+}
+
+void FeedArbiter::accept(std::size_t feed, FrameRef frame,
+                         std::chrono::steady_clock::time_point arrival,
+                         std::vector<FrameRef>& out) {
+    const auto ids = updateIdsOf(frame.text());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = feeds_[feed];
+    ++stats.frames;
+    if (ids.updateId == 0) {
+        out.push_back(std::move(frame));
+        return;
+    }
+
+    if (const Arrival* winner = findRecent(ids.updateId)) {
+        ++stats.duplicates;
+        const auto lag = std::chrono::duration_cast<std::chrono::microseconds>(arrival - winner->at);
+        const auto lagUs = static_cast<uint64_t>(std::max<int64_t>(0, lag.count()));
+        ++stats.lagSamples;
+        stats.totalLagUs += lagUs;
+        stats.maxLagUs = std::max(stats.maxLagUs, lagUs);
+        return;
+    }
+
+    const bool continues = lastForwarded_ == 0 || ids.previousUpdateId == 0 ||
+                           ids.previousUpdateId == lastForwarded_;
+    if (continues && ids.updateId > lastForwarded_) {
+        forward(feed, ids.updateId, std::move(frame), arrival, out);
+        drainHeld(out);
+        return;
+    }
+    // Older than the chain and no longer in the ring.
+    if (ids.updateId <= lastForwarded_ || held_.contains(ids.updateId)) {
+        ++stats.duplicates;
+        return;
+    }
+
+    ++stats.held;
+    if (held_.empty()) {
+        heldSince_ = arrival;
+    }
+    held_.emplace(ids.updateId, Held{
+                                    .feed = feed,
+                                    .previousUpdateId = ids.previousUpdateId,
+                                    .frame = std::move(frame),
+                                    .arrival = arrival,
+                                });
+    if (arrival - heldSince_ >= kGapGrace || held_.size() > kMaxHeld) {
+        flushHeld(out);
+    }
+}
+
+std::vector<FeedArbiter::FeedStats> FeedArbiter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return feeds_;
+}
+
+const FeedArbiter::Arrival* FeedArbiter::findRecent(uint64_t updateId) const {
+    const auto it = std::find_if(recent_.begin(), recent_.end(), [updateId](const Arrival& recent) {
+        return recent.updateId == updateId;
+    });
+    return it == recent_.end() ? nullptr : &*it;
+}
+
+void FeedArbiter::forward(std::size_t feed, uint64_t updateId, FrameRef frame,
+                          std::chrono::steady_clock::time_point arrival,
+                          std::vector<FrameRef>& out) {
+    lastForwarded_ = updateId;
+    recent_[nextRecent_] = Arrival{.updateId = updateId, .at = arrival};
+    nextRecent_ = (nextRecent_ + 1) % kRecentWinners;
+    ++feeds_[feed].wins;
+    out.push_back(std::move(frame));
+}
+
+void FeedArbiter::drainHeld(std::vector<FrameRef>& out) {
+    while (!held_.empty()) {
+        auto first = held_.begin();
+        if (first->first <= lastForwarded_) {
+            ++feeds_[first->second.feed].duplicates;
+            held_.erase(first);
+            continue;
+        }
+        if (first->second.previousUpdateId != lastForwarded_) {
+            break;
+        }
+        auto node = held_.extract(first);
+        forward(node.mapped().feed, node.key(), std::move(node.mapped().frame),
+                node.mapped().arrival, out);
+    }
+    if (!held_.empty()) {
+        heldSince_ = held_.begin()->second.arrival;
+    }
+}
+
+void FeedArbiter::flushHeld(std::vector<FrameRef>& out) {
+    for (auto& [updateId, held] : held_) {
+        forward(held.feed, updateId, std::move(held.frame), held.arrival, out);
+    }
+    held_.clear();
+}
+
+// Binance depth payloads carry `"u":<digits>` and `"pu":<digits>` once
+// each; `"pu":` does not match `"u":` because of the leading quote.
+FeedArbiter::UpdateIds FeedArbiter::updateIdsOf(std::string_view payload) {
+    return UpdateIds{
+        .updateId = parseId(payload, "\"u\":"),
+        .previousUpdateId = parseId(payload, "\"pu\":"),
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "FrameBuffer.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Merges redundant copies of one sequenced stream arriving over several
+// connections, forwarding in `pu` chain order. The first copy of an update
+// that continues the chain is forwarded; later copies are dropped and timed
+// against it, which gives each feed's lag. A copy that skips ahead of the
+// chain, because its feed missed updates (say, just after a reconnect), is
+// held until another feed fills the gap. Only if none does within
+// kGapGrace are the held copies forwarded as they are. Thread-safe.
+class FeedArbiter {
+  public:
+    struct FeedStats {
+        uint64_t frames = 0;
+        uint64_t wins = 0;
+        uint64_t duplicates = 0;
+        // Copies held for a gap in the chain.
+        uint64_t held = 0;
+        // Lag behind the winning copy, over the duplicates matched to it.
+        uint64_t lagSamples = 0;
+        uint64_t totalLagUs = 0;
+        uint64_t maxLagUs = 0;
+
+        FeedStats& operator+=(const FeedStats& other);
+    };
+
+    struct UpdateIds {
+        // `u`; 0 for frames that are not depth updates.
+        uint64_t updateId = 0;
+        // `pu`; 0 where the stream does not carry it, which leaves only
+        // deduplication.
+        uint64_t previousUpdateId = 0;
+    };
+
+    // How long held copies wait for another feed to fill their gap. Checked
+    // as frames arrive.
+    static constexpr std::chrono::milliseconds kGapGrace{500};
+
+    explicit FeedArbiter(std::size_t feeds);
+
+    // Appends to `out` the frames to forward now, in order: `frame` itself,
+    // nothing, or held frames that `frame` unblocked after it. Frames
+    // without an update id are always forwarded.
+    void accept(std::size_t feed, FrameRef frame, std::chrono::steady_clock::time_point arrival,
+                std::vector<FrameRef>& out);
+    std::vector<FeedStats> stats() const;
+
+    static UpdateIds updateIdsOf(std::string_view payload);
+
+  private:
+    struct Arrival {
+        uint64_t updateId = 0;
+        std::chrono::steady_clock::time_point at{};
+    };
+
+    struct Held {
+        std::size_t feed = 0;
+        uint64_t previousUpdateId = 0;
+        FrameRef frame;
+        std::chrono::steady_clock::time_point arrival{};
+    };
+
+    // Forwarded ids kept for duplicate matching; a copy lagging by more
+    // than this many updates is still dropped but not timed.
+    static constexpr std::size_t kRecentWinners = 64;
+    // Held copies beyond this are forwarded without waiting out the grace.
+    static constexpr std::size_t kMaxHeld = 256;
+
+    const Arrival* findRecent(uint64_t updateId) const;
+    void forward(std::size_t feed, uint64_t updateId, FrameRef frame,
+                 std::chrono::steady_clock::time_point arrival, std::vector<FrameRef>& out);
+    // Forwards held copies that now continue the chain, and drops those
+    // the chain has passed.
+    void drainHeld(std::vector<FrameRef>& out);
+    // Gives up on the gap: every held copy goes out in update order.
+    void flushHeld(std::vector<FrameRef>& out);
+
+    mutable std::mutex mutex_;
+    uint64_t lastForwarded_ = 0;
+    // Ring of the latest forwarded ids, in forwarding order.
+    std::array<Arrival, kRecentWinners> recent_{};
+    std::size_t nextRecent_ = 0;
+    // By update id.
+    std::map<uint64_t, Held> held_;
+    std::chrono::steady_clock::time_point heldSince_{};
+    std::vector<FeedStats> feeds_;
+};
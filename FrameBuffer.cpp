@@ -0,0 +1,118 @@
+#include "FrameBuffer.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstring>
+#include <utility>
+
+void FrameBuffer::release(FrameBuffer* frame) {
+    if (frame->refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    // The local keeps the pool alive through recycle() even when this was
+    // the last frame referencing a pool nobody else holds any more.
+    auto owner = std::move(frame->owner_);
+    owner->recycle(frame);
+}
+
+FrameRef::FrameRef(const FrameRef& other)
+    : frame_(other.frame_), view_(other.view_) {
+    if (frame_) {
+        frame_->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameRef::FrameRef(FrameRef&& other) noexcept
+    : frame_(std::exchange(other.frame_, nullptr)), view_(std::exchange(other.view_, {})) {
+}
+
+FrameRef& FrameRef::operator=(FrameRef other) noexcept {
+    std::swap(frame_, other.frame_);
+    std::swap(view_, other.view_);
+    return *this;
+}
+
+FrameRef::~FrameRef() {
+    if (frame_) {
+        FrameBuffer::release(frame_);
+    }
+}
+
+FrameRef FrameRef::slice(std::string_view sub) const {
+    FrameRef copy(*this);
+    copy.view_ = sub;
+    return copy;
+}
+
+FrameLease::FrameLease(FrameLease&& other) noexcept
+    : frame_(std::exchange(other.frame_, nullptr)) {
+}
+
+FrameLease& FrameLease::operator=(FrameLease&& other) noexcept {
+    if (this != &other) {
+        if (frame_) {
+            FrameBuffer::release(frame_);
+        }
+        frame_ = std::exchange(other.frame_, nullptr);
+    }
+    return *this;
+}
+
+FrameLease::~FrameLease() {
+    if (frame_) {
+        FrameBuffer::release(frame_);
+    }
+}
+
+FrameRef FrameLease::publish() {
+    FrameBuffer* frame = std::exchange(frame_, nullptr);
+    frame->receivedAt_ = std::chrono::steady_clock::now();
+    const auto data = frame->buffer_.cdata();
+    return FrameRef(frame, std::string_view(static_cast<const char*>(data.data()), data.size()));
+}
+
+std::shared_ptr<FrameBufferPool> FrameBufferPool::create(std::size_t initialFrames) {
+    std::shared_ptr<FrameBufferPool> pool(new FrameBufferPool());
+    pool->frames_.reserve(initialFrames);
+    pool->free_.reserve(initialFrames);
+    for (std::size_t i = 0; i < initialFrames; ++i) {
+        pool->frames_.push_back(std::make_unique<FrameBuffer>());
+        pool->free_.push_back(pool->frames_.back().get());
+    }
+    return pool;
+}
+
+FrameLease FrameBufferPool::acquire() {
+    FrameBuffer* frame = nullptr;
+    {
+        std::lock_guard lock(mutex_);
+        if (free_.empty()) {
+            frames_.push_back(std::make_unique<FrameBuffer>());
+            free_.reserve(frames_.size());
+            frame = frames_.back().get();
+        } else {
+            frame = free_.back();
+            free_.pop_back();
+        }
+    }
+    frame->refs_.store(1, std::memory_order_relaxed);
+    frame->owner_ = shared_from_this();
+    return FrameLease(frame);
+}
+
+FrameRef FrameBufferPool::copy(std::string_view text) {
+    FrameLease lease = acquire();
+    auto& buffer = lease.buffer();
+    const auto dest = buffer.prepare(text.size());
+    std::memcpy(dest.data(), text.data(), text.size());
+    buffer.commit(text.size());
+    return lease.publish();
+}
+
+void FrameBufferPool::recycle(FrameBuffer* frame) {
+    // consume() keeps the allocation, so a recycled frame reads the next
+    // message of similar size without touching the heap.
+    frame->buffer_.consume(frame->buffer_.size());
+    std::lock_guard lock(mutex_);
+    free_.push_back(frame);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <boost/beast/core/flat_buffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+class FrameBufferPool;
+
+// Pooled receive buffer. Producers fill it through a FrameLease and publish
+// it as a reference-counted FrameRef; when the last reference is dropped the
+// buffer (and its capacity) goes back to the pool.
+class FrameBuffer {
+  private:
+    friend class FrameBufferPool;
+    friend class FrameLease;
+    friend class FrameRef;
+
+    static void release(FrameBuffer* frame);
+
+    boost::beast::flat_buffer buffer_;
+    // When the frame was published, i.e. its read completed.
+    std::chrono::steady_clock::time_point receivedAt_{};
+    std::atomic<uint32_t> refs_{0};
+    std::shared_ptr<FrameBufferPool> owner_;
+};
+
+// Read-only, shareable view of a received frame.
+class FrameRef {
+  public:
+    FrameRef() = default;
+    FrameRef(const FrameRef& other);
+    FrameRef(FrameRef&& other) noexcept;
+    FrameRef& operator=(FrameRef other) noexcept;
+    ~FrameRef();
+
+    std::string_view text() const {
+        return view_;
+    }
+    explicit operator bool() const {
+        return frame_ != nullptr;
+    }
+    // Shared by every slice of the frame; epoch when empty.
+    std::chrono::steady_clock::time_point receivedAt() const {
+        return frame_ ? frame_->receivedAt_ : std::chrono::steady_clock::time_point{};
+    }
+    // Same frame, narrower view; `sub` must point into text().
+    FrameRef slice(std::string_view sub) const;
+
+  private:
+    friend class FrameLease;
+
+    FrameRef(FrameBuffer* frame, std::string_view view)
+        : frame_(frame), view_(view) {
+    }
+
+    FrameBuffer* frame_ = nullptr;
+    std::string_view view_;
+};
+
+// Exclusive, writable handle to a buffer taken from the pool.
+class FrameLease {
+  public:
+    FrameLease() = default;
+    FrameLease(const FrameLease&) = delete;
+    FrameLease& operator=(const FrameLease&) = delete;
+    FrameLease(FrameLease&& other) noexcept;
+    FrameLease& operator=(FrameLease&& other) noexcept;
+    ~FrameLease();
+
+    boost::beast::flat_buffer& buffer() {
+        return frame_->buffer_;
+    }
+    // Hands the filled buffer to readers, stamped with the current time;
+    // the lease becomes empty.
+    FrameRef publish();
+
+  private:
+    friend class FrameBufferPool;
+
+    explicit FrameLease(FrameBuffer* frame)
+        : frame_(frame) {
+    }
+
+    FrameBuffer* frame_ = nullptr;
+};
+
+class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool> {
+  public:
+    static std::shared_ptr<FrameBufferPool> create(std::size_t initialFrames = 8);
+
+    FrameLease acquire();
+    // Copies `text` into a pooled buffer, for producers that do not read
+    // straight into a lease.
+    FrameRef copy(std::string_view text);
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+  private:
+    friend class FrameBuffer;
+
+    FrameBufferPool() = default;
+    void recycle(FrameBuffer* frame);
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<FrameBuffer>> frames_;
+    std::vector<FrameBuffer*> free_;
+};
@@ -0,0 +1,438 @@
+#include "HttpsClient.h"
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/ssl/host_name_verification.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <iostream>
+#include <openssl/ssl.h>
+
+namespace {
+namespace asio = boost::asio;
+namespace ssl = asio::ssl;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+using Strand = asio::strand<asio::io_context::executor_type>;
+} // namespace
+
+// One TLS connection. It is single-use: once it fails or the server asks to
+// close, the client drops it and opens a new one, so the stream never has
+// to be re-seated under pending operations. Runs on the client's strand.
+class HttpsClient::Connection : public std::enable_shared_from_this<Connection> {
+  public:
+    Connection(std::weak_ptr<HttpsClient> client, Strand strand, ssl::context& tls,
+               Options options)
+        : client_(std::move(client)),
+          options_(std::move(options)),
+          resolver_(strand),
+          stream_(strand, tls),
+          pingTimer_(strand) {
+    }
+
+    bool ready() const {
+        return state_ == State::Ready;
+    }
+    bool connecting() const {
+        return state_ == State::Connecting;
+    }
+    bool alive() const {
+        return state_ != State::Dead;
+    }
+    std::optional<RequestId> currentRequest() const {
+        if (state_ != State::Busy) {
+            return std::nullopt;
+        }
+        return current_.id;
+    }
+    void dropCallback() {
+        current_.onResponse = nullptr;
+    }
+
+    void connect(SSL_SESSION* session) {
+        state_ = State::Connecting;
+        session_ = session;
+        resolver_.async_resolve(options_.host, options_.port,
+                                beast::bind_front_handler(&Connection::onResolve,
+                                                          shared_from_this()));
+    }
+
+    void send(PendingRequest request) {
+        pingTimer_.cancel();
+        state_ = State::Busy;
+        reused_ = served_ > 0;
+        current_ = std::move(request);
+
+        req_ = http::request<http::empty_body>{http::verb::get, current_.target, 11};
+        req_.set(http::field::host, options_.host);
+        req_.set(http::field::user_agent, "orderbook/1.0");
+        req_.keep_alive(true);
+
+        beast::get_lowest_layer(stream_).expires_after(options_.requestTimeout);
+        http::async_write(stream_, req_,
+                          beast::bind_front_handler(&Connection::onWrite, shared_from_this()));
+    }
+
+    void close() {
+        state_ = State::Dead;
+        pingTimer_.cancel();
+        resolver_.cancel();
+        beast::error_code ignored;
+        auto& socket = beast::get_lowest_layer(stream_).socket();
+        socket.shutdown(tcp::socket::shutdown_both, ignored);
+        socket.close(ignored);
+    }
+
+  private:
+    enum class State {
+        Connecting,
+        Ready,
+        Busy,
+        Dead,
+    };
+
+    void onResolve(beast::error_code ec, const tcp::resolver::results_type& results) {
+        if (ec) {
+            failConnect("resolve", ec);
+            return;
+        }
+        beast::get_lowest_layer(stream_).expires_after(options_.requestTimeout);
+        beast::get_lowest_layer(stream_).async_connect(
+            results, beast::bind_front_handler(&Connection::onConnect, shared_from_this()));
+    }
+
+    void onConnect(beast::error_code ec, const tcp::resolver::results_type::endpoint_type&) {
+        if (ec) {
+            failConnect("connect", ec);
+            return;
+        }
+        if (!SSL_set_tlsext_host_name(stream_.native_handle(), options_.host.c_str())) {
+            failConnect("SNI setup", beast::error_code{});
+            return;
+        }
+        if (session_) {
+            SSL_set_session(stream_.native_handle(), session_);
+        }
+        stream_.set_verify_callback(ssl::host_name_verification(options_.host));
+        stream_.async_handshake(ssl::stream_base::client,
+                                beast::bind_front_handler(&Connection::onHandshake,
+                                                          shared_from_this()));
+    }
+
+    void onHandshake(beast::error_code ec) {
+        if (ec) {
+            failConnect("TLS handshake", ec);
+            return;
+        }
+        beast::get_lowest_layer(stream_).expires_never();
+        state_ = State::Ready;
+        if (auto client = client_.lock()) {
+            const bool resumed = SSL_session_reused(stream_.native_handle()) == 1;
+            client->updateStats([resumed](Stats& stats) {
+                ++stats.connects;
+                stats.resumedHandshakes += resumed ? 1 : 0;
+            });
+            client->onConnected(shared_from_this());
+        } else {
+            close();
+        }
+    }
+
+    void onWrite(beast::error_code ec, std::size_t) {
+        if (ec) {
+            finish(std::nullopt);
+            return;
+        }
+        res_ = {};
+        http::async_read(stream_, buffer_, res_,
+                         beast::bind_front_handler(&Connection::onRead, shared_from_this()));
+    }
+
+    void onRead(beast::error_code ec, std::size_t) {
+        if (ec) {
+            finish(std::nullopt);
+            return;
+        }
+        ++served_;
+        beast::get_lowest_layer(stream_).expires_never();
+        const bool keepAlive = res_.keep_alive();
+        Response response{
+            .status = static_cast<unsigned>(res_.result_int()),
+            .body = std::move(res_.body()),
+        };
+        // TLS 1.3 tickets arrive after the handshake, so the session is taken
+        // once the first response has been read.
+        if (served_ == 1 && options_.resumeTlsSessions) {
+            if (auto client = client_.lock()) {
+                client->storeSession(SSL_get1_session(stream_.native_handle()));
+            }
+        }
+        if (keepAlive) {
+            state_ = State::Ready;
+        }
+        finish(std::move(response));
+    }
+
+    void finish(std::optional<Response> response) {
+        if (!response || state_ != State::Ready) {
+            close();
+        }
+
+        auto client = client_.lock();
+        if (!client) {
+            close();
+            return;
+        }
+        client->onRequestDone(shared_from_this(), std::move(current_), std::move(response), reused_);
+        if (state_ == State::Ready) {
+            armPing();
+        }
+    }
+
+    void armPing() {
+        if (options_.pingTarget.empty() || options_.keepAliveInterval.count() <= 0) {
+            return;
+        }
+        pingTimer_.expires_after(options_.keepAliveInterval);
+        pingTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (ec || self->state_ != State::Ready) {
+                return;
+            }
+            if (auto client = self->client_.lock()) {
+                client->updateStats([](Stats& stats) { ++stats.pings; });
+                self->send(PendingRequest{
+                    .id = 0,
+                    .target = self->options_.pingTarget,
+                    .onResponse = nullptr,
+                    .retried = false,
+                });
+            }
+        });
+    }
+
+    void failConnect(const char* context, beast::error_code ec) {
+        std::cerr << "HttpsClient " << options_.host << ' ' << context
+                  << " failed: " << ec.message() << '\n';
+        close();
+        if (auto client = client_.lock()) {
+            client->onConnectFailed(shared_from_this());
+        }
+    }
+
+    std::weak_ptr<HttpsClient> client_;
+    const Options options_;
+    tcp::resolver resolver_;
+    beast::ssl_stream<beast::tcp_stream> stream_;
+    asio::steady_timer pingTimer_;
+    beast::flat_buffer buffer_;
+    http::request<http::empty_body> req_;
+    http::response<http::string_body> res_;
+    PendingRequest current_;
+    SSL_SESSION* session_ = nullptr;
+    State state_ = State::Connecting;
+    uint64_t served_ = 0;
+    bool reused_ = false;
+};
+
+std::shared_ptr<HttpsClient> HttpsClient::create(boost::asio::io_context& ioContext,
+                                                 Options options) {
+    return std::shared_ptr<HttpsClient>(new HttpsClient(ioContext, std::move(options)));
+}
+
+HttpsClient::HttpsClient(boost::asio::io_context& ioContext, Options options)
+    : strand_(asio::make_strand(ioContext)),
+      sslContext_(ssl::context::tls_client),
+      options_(std::move(options)) {
+    sslContext_.set_default_verify_paths();
+    sslContext_.set_verify_mode(ssl::verify_peer);
+    if (!options_.caFile.empty()) {
+        boost::system::error_code ec;
+        sslContext_.load_verify_file(options_.caFile, ec);
+        if (ec) {
+            std::cerr << "HttpsClient cannot load CA file " << options_.caFile << ": "
+                      << ec.message() << '\n';
+        }
+    }
+    if (options_.resumeTlsSessions) {
+        SSL_CTX_set_session_cache_mode(sslContext_.native_handle(), SSL_SESS_CACHE_CLIENT);
+    }
+}
+
+HttpsClient::~HttpsClient() {
+    for (auto& connection : connections_) {
+        asio::post(strand_, [connection]() { connection->close(); });
+    }
+    if (session_) {
+        SSL_SESSION_free(session_);
+    }
+}
+
+HttpsClient::RequestId HttpsClient::get(std::string target, OnResponse onResponse) {
+    const RequestId id = nextRequestId_.fetch_add(1, std::memory_order_relaxed);
+    asio::post(strand_, [self = shared_from_this(), id, target = std::move(target),
+                         onResponse = std::move(onResponse)]() mutable {
+        self->enqueue(PendingRequest{
+            .id = id,
+            .target = std::move(target),
+            .onResponse = std::move(onResponse),
+        });
+    });
+    return id;
+}
+
+void HttpsClient::cancel(RequestId id) {
+    asio::post(strand_, [self = shared_from_this(), id]() {
+        auto& queue = self->queue_;
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [id](const PendingRequest& request) { return request.id == id; }),
+                    queue.end());
+        for (auto& connection : self->connections_) {
+            if (connection->currentRequest() == id) {
+                connection->dropCallback();
+            }
+        }
+    });
+}
+
+void HttpsClient::warmUp() {
+    asio::post(strand_, [self = shared_from_this()]() {
+        if (!self->closed_ && self->connections_.empty()) {
+            self->openConnection();
+        }
+    });
+}
+
+void HttpsClient::close() {
+    asio::post(strand_, [self = shared_from_this()]() {
+        self->closed_ = true;
+        for (auto& connection : self->connections_) {
+            connection->close();
+        }
+        self->connections_.clear();
+        auto queue = std::move(self->queue_);
+        self->queue_.clear();
+        for (auto& request : queue) {
+            if (request.onResponse) {
+                request.onResponse(std::nullopt);
+            }
+        }
+    });
+}
+
+HttpsClient::Stats HttpsClient::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void HttpsClient::enqueue(PendingRequest request) {
+    if (closed_) {
+        if (request.onResponse) {
+            request.onResponse(std::nullopt);
+        }
+        return;
+    }
+    updateStats([](Stats& stats) { ++stats.requests; });
+    queue_.push_back(std::move(request));
+    dispatch();
+}
+
+void HttpsClient::dispatch() {
+    if (closed_) {
+        return;
+    }
+
+    std::size_t connecting = 0;
+    for (auto& connection : connections_) {
+        if (queue_.empty()) {
+            break;
+        }
+        if (connection->ready()) {
+            auto request = std::move(queue_.front());
+            queue_.pop_front();
+            connection->send(std::move(request));
+        } else if (connection->connecting()) {
+            ++connecting;
+        }
+    }
+
+    while (queue_.size() > connecting && connections_.size() < options_.maxConnections) {
+        openConnection();
+        ++connecting;
+    }
+}
+
+void HttpsClient::onConnected(const std::shared_ptr<Connection>&) {
+    dispatch();
+}
+
+void HttpsClient::onConnectFailed(const std::shared_ptr<Connection>& connection) {
+    dropConnection(connection);
+    const bool anyUsable = std::any_of(connections_.begin(), connections_.end(),
+                                       [](const auto& other) { return other->alive(); });
+    if (anyUsable) {
+        dispatch();
+        return;
+    }
+
+    // Host unreachable: fail what is queued rather than reconnect in a loop;
+    // callers own the retry policy.
+    auto queue = std::move(queue_);
+    queue_.clear();
+    for (auto& request : queue) {
+        if (request.onResponse) {
+            request.onResponse(std::nullopt);
+        }
+    }
+}
+
+void HttpsClient::onRequestDone(const std::shared_ptr<Connection>& connection,
+                                PendingRequest request, std::optional<Response> response,
+                                bool reusedConnection) {
+    if (!connection->alive()) {
+        dropConnection(connection);
+    }
+    if (response && reusedConnection && request.id != 0) {
+        updateStats([](Stats& stats) { ++stats.reusedRequests; });
+    }
+
+    // The server may close an idle keep-alive connection at any time; a
+    // request that hit such a connection gets one retry on a fresh one.
+    if (!response && reusedConnection && !request.retried && request.onResponse && !closed_) {
+        updateStats([](Stats& stats) { ++stats.retries; });
+        request.retried = true;
+        queue_.push_front(std::move(request));
+    } else if (request.onResponse) {
+        request.onResponse(std::move(response));
+    }
+    dispatch();
+}
+
+void HttpsClient::storeSession(SSL_SESSION* session) {
+    if (!session) {
+        return;
+    }
+    if (session_) {
+        SSL_SESSION_free(session_);
+    }
+    session_ = session;
+}
+
+std::shared_ptr<HttpsClient::Connection> HttpsClient::openConnection() {
+    auto connection = std::make_shared<Connection>(weak_from_this(), strand_, sslContext_, options_);
+    connections_.push_back(connection);
+    connection->connect(options_.resumeTlsSessions ? session_ : nullptr);
+    return connection;
+}
+
+void HttpsClient::dropConnection(const std::shared_ptr<Connection>& connection) {
+    connections_.erase(std::remove(connections_.begin(), connections_.end(), connection),
+                       connections_.end());
+}
+
+template <typename Update> void HttpsClient::updateStats(Update update) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    update(stats_);
+}
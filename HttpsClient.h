@@ -0,0 +1,114 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/strand.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+typedef struct ssl_session_st SSL_SESSION;
+
+// Keep-alive HTTPS GET client for one REST host. Connections are opened on
+// demand up to `maxConnections`, reused across requests and kept warm with
+// a periodic ping, so a request normally costs one round trip. Connections
+// the server dropped are reopened transparently; a request that fails on a
+// reused connection is retried once on a fresh one. TLS sessions are
+// cached and offered on reconnect to skip the full handshake.
+class HttpsClient : public std::enable_shared_from_this<HttpsClient> {
+  public:
+    struct Options {
+        std::string host;
+        std::string port = "443";
+        std::size_t maxConnections = 2;
+        std::chrono::milliseconds requestTimeout{10000};
+        // Idle connections GET `pingTarget` this often; empty disables pings.
+        std::chrono::milliseconds keepAliveInterval{30000};
+        std::string pingTarget;
+        bool resumeTlsSessions = true;
+        // PEM bundle trusted in addition to the system store.
+        std::string caFile;
+    };
+
+    struct Response {
+        unsigned status = 0;
+        std::string body;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t reusedRequests = 0;
+        uint64_t connects = 0;
+        uint64_t resumedHandshakes = 0;
+        uint64_t retries = 0;
+        uint64_t pings = 0;
+    };
+
+    using RequestId = uint64_t;
+    using OnResponse = std::function<void(std::optional<Response>)>;
+
+    static std::shared_ptr<HttpsClient> create(boost::asio::io_context& ioContext, Options options);
+    HttpsClient(const HttpsClient&) = delete;
+    HttpsClient& operator=(const HttpsClient&) = delete;
+    ~HttpsClient();
+
+    // `onResponse` runs on the client's strand with nullopt on transport
+    // failure; non-2xx responses are delivered as-is.
+    RequestId get(std::string target, OnResponse onResponse);
+    // Drops the callback; a request already on the wire still completes so
+    // its connection stays usable.
+    void cancel(RequestId id);
+    // Opens a connection ahead of the first request.
+    void warmUp();
+    void close();
+
+    Stats stats() const;
+    // Handlers run here are serialized with response callbacks.
+    boost::asio::strand<boost::asio::io_context::executor_type> executor() const {
+        return strand_;
+    }
+
+  private:
+    class Connection;
+
+    struct PendingRequest {
+        RequestId id = 0;
+        std::string target;
+        OnResponse onResponse;
+        bool retried = false;
+    };
+
+    HttpsClient(boost::asio::io_context& ioContext, Options options);
+
+    void enqueue(PendingRequest request);
+    void dispatch();
+    void onConnected(const std::shared_ptr<Connection>& connection);
+    void onConnectFailed(const std::shared_ptr<Connection>& connection);
+    void onRequestDone(const std::shared_ptr<Connection>& connection, PendingRequest request,
+                       std::optional<Response> response, bool reusedConnection);
+    void storeSession(SSL_SESSION* session);
+    std::shared_ptr<Connection> openConnection();
+    void dropConnection(const std::shared_ptr<Connection>& connection);
+    template <typename Update> void updateStats(Update update);
+
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    boost::asio::ssl::context sslContext_;
+    const Options options_;
+
+    std::vector<std::shared_ptr<Connection>> connections_;
+    std::deque<PendingRequest> queue_;
+    std::atomic<RequestId> nextRequestId_{1};
+    SSL_SESSION* session_ = nullptr;
+    bool closed_ = false;
+
+    mutable std::mutex statsMutex_;
+    Stats stats_{};
+};
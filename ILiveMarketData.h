@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FrameBuffer.h"
+
 #include <functional>
 #include <string>
 #include <string_view>
@@ -7,8 +9,33 @@
 class ILiveMarketData {
   public:
     using OnText = std::function<void(std::string)>;
+    // Frames reference pooled receive buffers; holding a FrameRef keeps its
+    // bytes valid, dropping the last one returns the buffer to the pool.
+    using OnFrame = std::function<void(FrameRef)>;
+
+    // Down: frames stopped arriving (disconnect or stale stream). Up: a
+    // stream is live again; frames may have been missed since Down.
+    enum class LinkState {
+        Down,
+        Up,
+    };
+    using OnLinkState = std::function<void(LinkState)>;
 
     virtual ~ILiveMarketData() = default;
     virtual void start(std::string_view symbol, OnText onText) = 0;
     virtual void stop() = 0;
+
+    // Takes effect from the next start. Sources without a connection of
+    // their own never report.
+    virtual void setOnLinkState(OnLinkState) {
+    }
+
+    // Zero-copy delivery. The default adapts start(), copying each message
+    // into a pooled frame, for sources that only produce strings.
+    virtual void startFrames(std::string_view symbol, OnFrame onFrame) {
+        start(symbol, [pool = FrameBufferPool::create(),
+                       onFrame = std::move(onFrame)](std::string text) {
+            onFrame(pool->copy(text));
+        });
+    }
 };
@@ -9,7 +9,13 @@
 class ISnapshotSource {
   public:
     using OnSnapshot = std::function<void(std::optional<OrderBookSnapshot>)>;
+    using OnRawSnapshot = std::function<void(std::string_view)>;
 
     virtual ~ISnapshotSource() = default;
     virtual void getSnapshotAsync(OnSnapshot onSnapshot) = 0;
+
+    // Sees the body of every snapshot just before OnSnapshot gets it.
+    // Sources that do not parse a body themselves never call it.
+    virtual void setOnRawSnapshot(OnRawSnapshot) {
+    }
 };
@@ -0,0 +1,101 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+uint64_t LatencyHistogram::highestOf(std::size_t bucket) {
+    const std::size_t row = bucket / kSubBuckets;
+    if (row == 0) {
+        return bucket;
+    }
+    const std::size_t shift = row - 1;
+    const uint64_t low = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return low + (uint64_t{1} << shift) - 1;
+}
+
+uint64_t LatencyHistogram::rankOf(double percentile) const {
+    const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count_);
+    return std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(rank)));
+}
+
+uint64_t LatencyHistogram::valueAt(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    const uint64_t target = rankOf(percentile);
+    uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += buckets_[bucket];
+        if (seen >= target) {
+            return std::min(highestOf(bucket), maxNs_);
+        }
+    }
+    return maxNs_;
+}
+
+// One pass over the buckets for all four percentiles.
+LatencyHistogram::Percentiles LatencyHistogram::percentiles() const {
+    Percentiles result{.count = count_, .maxNs = maxNs_};
+    if (count_ == 0) {
+        return result;
+    }
+    const std::array<std::pair<uint64_t, uint64_t*>, 4> targets{{
+        {rankOf(50.0), &result.p50Ns},
+        {rankOf(90.0), &result.p90Ns},
+        {rankOf(99.0), &result.p99Ns},
+        {rankOf(99.9), &result.p999Ns},
+    }};
+    std::size_t next = 0;
+    uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < kBuckets && next < targets.size(); ++bucket) {
+        seen += buckets_[bucket];
+        while (next < targets.size() && seen >= targets[next].first) {
+            *targets[next].second = std::min(highestOf(bucket), maxNs_);
+            ++next;
+        }
+    }
+    return result;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        buckets_[bucket] += other.buckets_[bucket];
+    }
+    count_ += other.count_;
+    maxNs_ = std::max(maxNs_, other.maxNs_);
+}
+
+void LatencyHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    maxNs_ = 0;
+}
+
+LatencyHistogram::Percentiles RollingLatencyHistogram::percentiles(
+    std::chrono::steady_clock::time_point now) {
+    rotate(now);
+    merged_ = previous_;
+    merged_.merge(current_);
+    return merged_.percentiles();
+}
+
+void RollingLatencyHistogram::reset() {
+    windowStart_ = {};
+    previous_.reset();
+    current_.reset();
+}
+
+void RollingLatencyHistogram::rotate(std::chrono::steady_clock::time_point now) {
+    if (now - windowStart_ < window_) {
+        return;
+    }
+    // A gap of two windows or more leaves nothing recent.
+    if (now - windowStart_ < 2 * window_) {
+        previous_ = current_;
+    } else {
+        previous_.reset();
+    }
+    current_.reset();
+    windowStart_ = now;
+}
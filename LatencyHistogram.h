@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram of durations in nanoseconds, in the spirit of
+// HdrHistogram: each power of two is split into 16 equal buckets, so a
+// reported value is within 1/16 of the true one. Below 16 ns buckets are
+// exact; from 2^36 ns (about 69 s) everything shares the top bucket.
+// Recording is a bit scan and an increment. Not thread-safe.
+class LatencyHistogram {
+  public:
+    struct Percentiles {
+        uint64_t count = 0;
+        uint64_t p50Ns = 0;
+        uint64_t p90Ns = 0;
+        uint64_t p99Ns = 0;
+        uint64_t p999Ns = 0;
+        uint64_t maxNs = 0;
+    };
+
+    void record(uint64_t ns) {
+        ++buckets_[bucketOf(ns)];
+        ++count_;
+        if (ns > maxNs_) {
+            maxNs_ = ns;
+        }
+    }
+    void record(std::chrono::steady_clock::duration elapsed) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        record(ns < 0 ? 0 : static_cast<uint64_t>(ns));
+    }
+
+    // Highest value of the bucket holding the `percentile`th sample, capped
+    // at the largest value recorded; 0 when empty.
+    uint64_t valueAt(double percentile) const;
+    Percentiles percentiles() const;
+    uint64_t count() const {
+        return count_;
+    }
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+  private:
+    static constexpr uint32_t kSubBits = 4;
+    static constexpr uint32_t kSubBuckets = 1U << kSubBits;
+    static constexpr uint32_t kMaxBits = 36;
+    static constexpr std::size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+    static std::size_t bucketOf(uint64_t ns) {
+        if (ns < kSubBuckets) {
+            return static_cast<std::size_t>(ns);
+        }
+        const auto magnitude = static_cast<uint32_t>(std::bit_width(ns)) - 1;
+        if (magnitude >= kMaxBits) {
+            return kBuckets - 1;
+        }
+        const auto shift = magnitude - kSubBits;
+        return (shift + 1) * kSubBuckets + static_cast<std::size_t>((ns >> shift) - kSubBuckets);
+    }
+    static uint64_t highestOf(std::size_t bucket);
+    // 1-based rank of the sample at `percentile`.
+    uint64_t rankOf(double percentile) const;
+
+    std::array<uint64_t, kBuckets> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t maxNs_ = 0;
+};
+
+// The recent past only: samples go to the current window, which replaces
+// the previous one after `window`. Percentiles cover both, so they span
+// between one and two windows. Not thread-safe.
+class RollingLatencyHistogram {
+  public:
+    explicit RollingLatencyHistogram(std::chrono::steady_clock::duration window)
+        : window_(window) {
+    }
+
+    void record(uint64_t ns, std::chrono::steady_clock::time_point now) {
+        rotate(now);
+        current_.record(ns);
+    }
+    LatencyHistogram::Percentiles percentiles(std::chrono::steady_clock::time_point now);
+    void reset();
+
+  private:
+    void rotate(std::chrono::steady_clock::time_point now);
+
+    std::chrono::steady_clock::duration window_;
+    std::chrono::steady_clock::time_point windowStart_{};
+    LatencyHistogram previous_;
+    LatencyHistogram current_;
+    // Reused by percentiles().
+    LatencyHistogram merged_;
+};
@@ -0,0 +1,231 @@
+#include "MultiSymbolEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <latch>
+#include <utility>
+
+namespace {
+// Snapshot requests of one shard share a few warm REST connections.
+constexpr std::size_t kRestConnectionsPerShard = 4;
+// Only busy while some symbol's snapshot has just landed.
+constexpr std::size_t kDecodeThreads = 2;
+constexpr auto kCheckpointInterval = std::chrono::seconds(5);
+} // namespace
+
+MultiSymbolEngine::MultiSymbolEngine(boost::asio::io_context& ioContext,
+                                     std::vector<SymbolConfig> symbols,
+                                     NodePool::Options poolOptions, uint64_t updateSpeedMs,
+                                     std::size_t feeds, std::vector<std::string> endpoints,
+                                     std::shared_ptr<CaptureJournal> capture,
+                                     std::shared_ptr<BookCheckpointWriter> checkpoints,
+                                     BinanceHosts hosts)
+    : decodePool_(kDecodeThreads) {
+    const std::vector<std::size_t> shardOf(symbols.size(), 0);
+    build({&ioContext}, std::move(symbols), shardOf, poolOptions, updateSpeedMs, feeds, endpoints,
+          capture, checkpoints, hosts);
+}
+
+MultiSymbolEngine::MultiSymbolEngine(ShardedRuntime& runtime, std::vector<SymbolConfig> symbols,
+                                     NodePool::Options poolOptions, uint64_t updateSpeedMs,
+                                     std::size_t feeds, std::vector<std::string> endpoints,
+                                     std::shared_ptr<CaptureJournal> capture,
+                                     std::shared_ptr<BookCheckpointWriter> checkpoints,
+                                     BinanceHosts hosts)
+    : decodePool_(kDecodeThreads) {
+    std::vector<boost::asio::io_context*> contexts;
+    for (std::size_t i = 0; i < runtime.shardCount(); ++i) {
+        contexts.push_back(&runtime.shard(i));
+    }
+    std::vector<std::size_t> shardOf;
+    shardOf.reserve(symbols.size());
+    for (const auto& config : symbols) {
+        shardOf.push_back(runtime.shardFor(config.symbol));
+    }
+    build(contexts, std::move(symbols), shardOf, poolOptions, updateSpeedMs, feeds, endpoints,
+          capture, checkpoints, hosts);
+}
+
+MultiSymbolEngine::~MultiSymbolEngine() {
+    for (auto& marketData : marketData_) {
+        if (marketData) {
+            marketData->stop();
+        }
+    }
+}
+
+// WebSocket subscribe, REST TLS handshakes and any pending scales fetch
+// all proceed at once; nothing here waits on another leg.
+void MultiSymbolEngine::start() {
+    for (auto& client : restClients_) {
+        if (client) {
+            client->warmUp();
+        }
+    }
+    if (exchangeClock_) {
+        exchangeClock_->start();
+    }
+    for (auto& book : books_) {
+        book->sync->start(book->config.symbol);
+    }
+    for (auto& marketData : marketData_) {
+        if (marketData) {
+            marketData->start();
+        }
+    }
+}
+
+void MultiSymbolEngine::stop() {
+    std::latch stopped(static_cast<std::ptrdiff_t>(books_.size()));
+    for (auto& book : books_) {
+        book->sync->stop([&stopped]() { stopped.count_down(); });
+    }
+    stopped.wait();
+    if (exchangeClock_) {
+        exchangeClock_->stop();
+    }
+    for (auto& client : restClients_) {
+        if (client) {
+            client->close();
+        }
+    }
+    for (auto& marketData : marketData_) {
+        if (marketData) {
+            marketData->stop();
+        }
+    }
+}
+
+void MultiSymbolEngine::updateScales(const BinanceScalesSource::ScalesBySymbol& scales) {
+    for (auto& book : books_) {
+        const auto it = scales.find(book->config.symbol);
+        if (it == scales.end() || it->second == book->config.scales) {
+            continue;
+        }
+        book->config.scales = it->second;
+        book->snapshotSource->setScales(it->second);
+        book->sync->updateScales(it->second);
+    }
+}
+
+bool MultiSymbolEngine::scalesFetchFailed() {
+    bool waiting = false;
+    for (auto& book : books_) {
+        if (!book->config.scales) {
+            book->sync->scalesFetchFailed();
+            waiting = true;
+        }
+    }
+    return waiting;
+}
+
+void MultiSymbolEngine::scalesMissing(const std::vector<std::string>& symbols) {
+    for (auto& book : books_) {
+        if (!book->config.scales && std::find(symbols.begin(), symbols.end(),
+                                              book->config.symbol) != symbols.end()) {
+            book->sync->scalesMissing();
+        }
+    }
+}
+
+uint64_t MultiSymbolEngine::unroutedFrames() const {
+    uint64_t total = 0;
+    for (const auto& marketData : marketData_) {
+        if (marketData) {
+            total += marketData->unroutedFrames();
+        }
+    }
+    return total;
+}
+
+std::optional<ExchangeClock::Estimate> MultiSymbolEngine::clockEstimate() const {
+    return exchangeClock_ ? exchangeClock_->estimate() : std::nullopt;
+}
+
+MultiSymbolEngine::ConnectionStats MultiSymbolEngine::connectionStats() const {
+    ConnectionStats total;
+    for (const auto& marketData : marketData_) {
+        if (!marketData) {
+            continue;
+        }
+        total.link += marketData->linkStats();
+        const auto feeds = marketData->feedStats();
+        total.feeds.resize(std::max(total.feeds.size(), feeds.size()));
+        for (std::size_t feed = 0; feed < feeds.size(); ++feed) {
+            total.feeds[feed] += feeds[feed];
+        }
+    }
+    return total;
+}
+
+void MultiSymbolEngine::build(const std::vector<boost::asio::io_context*>& contexts,
+                              std::vector<SymbolConfig> symbols,
+                              const std::vector<std::size_t>& shardOf,
+                              NodePool::Options poolOptions, uint64_t updateSpeedMs,
+                              std::size_t feeds, const std::vector<std::string>& endpoints,
+                              const std::shared_ptr<CaptureJournal>& capture,
+                              const std::shared_ptr<BookCheckpointWriter>& checkpoints,
+                              const BinanceHosts& hosts) {
+    std::vector<std::vector<std::string>> shardSymbols(contexts.size());
+    std::vector<bool> keep(symbols.size(), false);
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        auto& names = shardSymbols[shardOf[i]];
+        if (std::find(names.begin(), names.end(), symbols[i].symbol) != names.end()) {
+            continue;
+        }
+        names.push_back(symbols[i].symbol);
+        keep[i] = true;
+    }
+
+    marketData_.resize(contexts.size());
+    restClients_.resize(contexts.size());
+    for (std::size_t shard = 0; shard < contexts.size(); ++shard) {
+        if (shardSymbols[shard].empty()) {
+            continue;
+        }
+        marketData_[shard] = std::make_unique<BinanceCombinedMarketData>(
+            *contexts[shard], std::move(shardSymbols[shard]), updateSpeedMs, feeds, endpoints,
+            hosts);
+        auto restOptions = BinanceSnapshotSource::restOptions(hosts);
+        restOptions.maxConnections = kRestConnectionsPerShard;
+        restClients_[shard] = HttpsClient::create(*contexts[shard], std::move(restOptions));
+        if (!exchangeClock_) {
+            exchangeClock_ = ExchangeClock::create(restClients_[shard]);
+        }
+    }
+
+    books_.reserve(symbols.size());
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        if (!keep[i]) {
+            continue;
+        }
+        auto& io = *contexts[shardOf[i]];
+        auto book = std::make_unique<SymbolBook>();
+        book->config = std::move(symbols[i]);
+        book->shard = shardOf[i];
+        book->snapshotSource = std::make_unique<BinanceSnapshotSource>(
+            restClients_[book->shard], book->config.symbol,
+            book->config.scales.value_or(SymbolScales{}), snapshotBudget_);
+        ILiveMarketData* liveMarketData = &marketData_[book->shard]->channel(book->config.symbol);
+        if (capture) {
+            book->recorder = std::make_unique<RecordingLiveMarketData>(*liveMarketData, capture);
+            liveMarketData = book->recorder.get();
+            book->snapshotSource->setOnRawSnapshot(
+                [capture, symbol = book->config.symbol](std::string_view body) {
+                    capture->record(CaptureJournal::RecordType::Snapshot, symbol, body);
+                });
+        }
+        book->sync = std::make_unique<BinanceOrderBookSync>(io, *book->snapshotSource,
+                                                            *liveMarketData, book->config.scales,
+                                                            poolOptions);
+        book->sync->setDecodeExecutor(decodePool_.get_executor());
+        book->sync->setExchangeClock(exchangeClock_);
+        if (checkpoints) {
+            book->sync->setCheckpointWriter(checkpoints, kCheckpointInterval);
+            if (auto checkpoint = checkpoints->load(book->config.symbol)) {
+                book->sync->setWarmStart(std::move(*checkpoint));
+            }
+        }
+        books_.push_back(std::move(book));
+    }
+}
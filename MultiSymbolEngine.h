@@ -0,0 +1,131 @@
+#pragma once
+
+#include "BinanceCombinedMarketData.h"
+#include "BinanceScalesSource.h"
+#include "BinanceOrderBookSync.h"
+#include "BinanceSnapshotSource.h"
+#include "BookCheckpointWriter.h"
+#include "CaptureJournal.h"
+#include "ExchangeClock.h"
+#include "HttpsClient.h"
+#include "NodePool.h"
+#include "RecordingLiveMarketData.h"
+#include "RequestWeightBudget.h"
+#include "ShardedRuntime.h"
+#include "Types.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Runs one BinanceOrderBookSync per symbol over shared combined-stream
+// connections. Each symbol keeps its own snapshot source, strand and book,
+// so a gap on one symbol resyncs only that symbol. With a ShardedRuntime,
+// every shard gets its own connections carrying only its symbols, so a
+// frame is read, routed and applied on the shard that owns the book.
+class MultiSymbolEngine {
+  public:
+    struct ConnectionStats {
+        // Per redundant feed; empty with a single feed.
+        std::vector<FeedArbiter::FeedStats> feeds;
+        BinanceLiveMarketData::LinkStats link;
+    };
+
+    struct SymbolConfig {
+        std::string symbol;
+        // Unknown scales may be supplied later through updateScales(); the
+        // symbol connects and subscribes meanwhile.
+        std::optional<SymbolScales> scales;
+    };
+
+    // `feeds` parallel connections carry every stream group, spread over
+    // `endpoints` (resolved stream host addresses) when given. With
+    // `capture`, every frame and snapshot body is journaled per symbol.
+    // With `checkpoints`, each book is checkpointed periodically and warm
+    // started from its last checkpoint. `hosts` redirects every connection.
+    MultiSymbolEngine(boost::asio::io_context& ioContext, std::vector<SymbolConfig> symbols,
+                      NodePool::Options poolOptions = {}, uint64_t updateSpeedMs = 100,
+                      std::size_t feeds = 1, std::vector<std::string> endpoints = {},
+                      std::shared_ptr<CaptureJournal> capture = {},
+                      std::shared_ptr<BookCheckpointWriter> checkpoints = {},
+                      BinanceHosts hosts = {});
+    MultiSymbolEngine(ShardedRuntime& runtime, std::vector<SymbolConfig> symbols,
+                      NodePool::Options poolOptions = {}, uint64_t updateSpeedMs = 100,
+                      std::size_t feeds = 1, std::vector<std::string> endpoints = {},
+                      std::shared_ptr<CaptureJournal> capture = {},
+                      std::shared_ptr<BookCheckpointWriter> checkpoints = {},
+                      BinanceHosts hosts = {});
+    MultiSymbolEngine(const MultiSymbolEngine&) = delete;
+    MultiSymbolEngine& operator=(const MultiSymbolEngine&) = delete;
+    ~MultiSymbolEngine();
+
+    void start();
+    // Blocks until every sync has stopped and written its final checkpoint,
+    // so the shards must still be running; never call it from a shard.
+    void stop();
+
+    std::size_t size() const {
+        return books_.size();
+    }
+    const std::string& symbol(std::size_t index) const {
+        return books_[index]->config.symbol;
+    }
+    const std::optional<SymbolScales>& scales(std::size_t index) const {
+        return books_[index]->config.scales;
+    }
+    std::size_t shardOf(std::size_t index) const {
+        return books_[index]->shard;
+    }
+    BinanceOrderBookSync& sync(std::size_t index) {
+        return *books_[index]->sync;
+    }
+    uint64_t unroutedFrames() const;
+    // Feed arbitration and reconnects over all shards.
+    ConnectionStats connectionStats() const;
+    // Offset of the exchange clock, shared by every sync's feed latency.
+    std::optional<ExchangeClock::Estimate> clockEstimate() const;
+
+    // Pushes changed scales to the affected symbols, each of which then
+    // resyncs on its own. Call from one thread at a time.
+    void updateScales(const BinanceScalesSource::ScalesBySymbol& scales);
+    // A scales fetch failed: each symbol still without scales counts it.
+    // Returns whether any symbol is still without scales.
+    bool scalesFetchFailed();
+    // Stops the symbols among `symbols` that have no scales, as exchangeInfo
+    // does not list them.
+    void scalesMissing(const std::vector<std::string>& symbols);
+
+  private:
+    struct SymbolBook {
+        SymbolConfig config;
+        std::size_t shard = 0;
+        std::unique_ptr<BinanceSnapshotSource> snapshotSource;
+        std::unique_ptr<RecordingLiveMarketData> recorder;
+        std::unique_ptr<BinanceOrderBookSync> sync;
+    };
+
+    void build(const std::vector<boost::asio::io_context*>& contexts,
+               std::vector<SymbolConfig> symbols, const std::vector<std::size_t>& shardOf,
+               NodePool::Options poolOptions, uint64_t updateSpeedMs, std::size_t feeds,
+               const std::vector<std::string>& endpoints,
+               const std::shared_ptr<CaptureJournal>& capture,
+               const std::shared_ptr<BookCheckpointWriter>& checkpoints,
+               const BinanceHosts& hosts);
+
+    // Indexed by shard; null for shards without symbols.
+    std::vector<std::unique_ptr<BinanceCombinedMarketData>> marketData_;
+    std::vector<std::shared_ptr<HttpsClient>> restClients_;
+    // On the first shard's REST client; one estimate serves every shard.
+    std::shared_ptr<ExchangeClock> exchangeClock_;
+    // Snapshot request weight is limited per IP, so all shards share it.
+    std::shared_ptr<RequestWeightBudget> snapshotBudget_ = BinanceSnapshotSource::makeBudget();
+    std::vector<std::unique_ptr<SymbolBook>> books_;
+    // Decodes held bootstrap events for every symbol. Declared last so its
+    // threads are joined before the syncs they post back to go away.
+    boost::asio::thread_pool decodePool_;
+};
@@ -0,0 +1,108 @@
+#include "NodePool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+constexpr std::size_t kPageSize = 4096;
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+constexpr std::size_t kBlockAlign = alignof(std::max_align_t);
+
+std::size_t roundUp(std::size_t value, std::size_t align) {
+    return (value + align - 1) / align * align;
+}
+} // namespace
+
+NodePool::NodePool(Options options)
+    : options_(options) {
+    options_.blockSize = roundUp(std::max(options_.blockSize, sizeof(FreeBlock)), kBlockAlign);
+    options_.blocksPerSlab = std::max<std::size_t>(options_.blocksPerSlab, 1);
+    for (std::size_t i = 0; i < options_.initialSlabs; ++i) {
+        addSlab();
+    }
+}
+
+NodePool::~NodePool() {
+    for (const auto& slab : slabs_) {
+#if defined(__linux__)
+        if (slab.mapped) {
+            ::munmap(slab.memory, slab.bytes);
+            continue;
+        }
+#endif
+        ::operator delete(slab.memory, std::align_val_t{kPageSize});
+    }
+}
+
+void* NodePool::allocate() {
+    if (!freeList_) {
+        addSlab();
+    }
+    FreeBlock* block = freeList_;
+    freeList_ = block->next;
+    ++stats_.inUse;
+    stats_.highWater = std::max(stats_.highWater, stats_.inUse);
+    return block;
+}
+
+void NodePool::deallocate(void* block) noexcept {
+    auto* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeList_;
+    freeList_ = freed;
+    --stats_.inUse;
+}
+
+void NodePool::addSlab() {
+    Slab slab;
+    slab.bytes = roundUp(options_.blockSize * options_.blocksPerSlab, kPageSize);
+
+#if defined(__linux__)
+    if (options_.hugePages) {
+        const std::size_t hugeBytes = roundUp(slab.bytes, kHugePageSize);
+        void* memory = ::mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED) {
+            // No reserved hugetlbfs pages: fall back to transparent huge pages.
+            memory = ::mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+            if (memory != MAP_FAILED) {
+                ::madvise(memory, hugeBytes, MADV_HUGEPAGE);
+            }
+        }
+        if (memory != MAP_FAILED) {
+            slab.memory = memory;
+            slab.bytes = hugeBytes;
+            slab.mapped = true;
+        } else {
+            std::cerr << "NodePool huge page slab failed, using regular pages\n";
+        }
+    }
+#endif
+
+    if (!slab.memory) {
+        slab.memory = ::operator new(slab.bytes, std::align_val_t{kPageSize});
+    }
+
+    auto* bytes = static_cast<unsigned char*>(slab.memory);
+    if (options_.prefault) {
+        for (std::size_t offset = 0; offset < slab.bytes; offset += kPageSize) {
+            bytes[offset] = 0;
+        }
+    }
+
+    // Thread the new blocks onto the free list in address order.
+    const std::size_t blocks = slab.bytes / options_.blockSize;
+    for (std::size_t i = blocks; i-- > 0;) {
+        auto* block = reinterpret_cast<FreeBlock*>(bytes + i * options_.blockSize);
+        block->next = freeList_;
+        freeList_ = block;
+    }
+
+    slabs_.push_back(slab);
+    stats_.slabs = slabs_.size();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size block pool backing order book level nodes. Blocks are carved
+// from preallocated slabs and recycled through an intrusive free list, so
+// inserting and erasing levels does no malloc/free once the pool has grown
+// to the book's working set. Not thread-safe: a pool belongs to one book and
+// is only touched from that book's strand.
+class NodePool {
+  public:
+    struct Options {
+        std::size_t blockSize = 64;
+        std::size_t blocksPerSlab = 4096;
+        std::size_t initialSlabs = 1;
+        // Back slabs with huge pages where the platform supports it.
+        bool hugePages = false;
+        // Touch every page of a new slab so first use does not page-fault.
+        bool prefault = true;
+    };
+
+    struct Stats {
+        std::size_t inUse = 0;
+        std::size_t highWater = 0;
+        std::size_t slabs = 0;
+    };
+
+    NodePool()
+        : NodePool(Options{}) {
+    }
+    explicit NodePool(Options options);
+    NodePool(const NodePool&) = delete;
+    NodePool(NodePool&&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    NodePool& operator=(NodePool&&) = delete;
+    ~NodePool();
+
+    void* allocate();
+    void deallocate(void* block) noexcept;
+
+    std::size_t blockSize() const {
+        return options_.blockSize;
+    }
+    Stats stats() const {
+        return stats_;
+    }
+
+  private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct Slab {
+        void* memory = nullptr;
+        std::size_t bytes = 0;
+        bool mapped = false;
+    };
+
+    void addSlab();
+
+    Options options_;
+    std::vector<Slab> slabs_;
+    FreeBlock* freeList_ = nullptr;
+    Stats stats_{};
+};
+
+// Standard allocator that serves single-object allocations of pool-sized
+// types from a shared NodePool and everything else from the heap. A
+// default-constructed allocator has no pool and behaves like std::allocator.
+template <typename T> class PoolAllocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PoolAllocator() noexcept = default;
+    explicit PoolAllocator(std::shared_ptr<NodePool> pool) noexcept
+        : pool_(std::move(pool)) {
+    }
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept
+        : pool_(other.pool_) {
+    }
+
+    T* allocate(std::size_t n) {
+        if (fromPool(n)) {
+            return static_cast<T*>(pool_->allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (fromPool(n)) {
+            pool_->deallocate(p);
+            return;
+        }
+        ::operator delete(p);
+    }
+
+    const std::shared_ptr<NodePool>& pool() const noexcept {
+        return pool_;
+    }
+
+    template <typename U> bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return pool_ == other.pool_;
+    }
+
+  private:
+    template <typename U> friend class PoolAllocator;
+
+    bool fromPool(std::size_t n) const noexcept {
+        return pool_ && n == 1 && sizeof(T) <= pool_->blockSize() &&
+               alignof(T) <= alignof(std::max_align_t);
+    }
+
+    std::shared_ptr<NodePool> pool_;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Two-level occupancy index over slot offsets. Each leaf word covers 64
+// slots and each summary bit marks a non-empty leaf word, so next/previous
+// set-bit lookups are a couple of count-zeros scans instead of a slot walk.
+class OccupancyBitmap {
+  public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit OccupancyBitmap(std::size_t bits = 0) {
+        resize(bits);
+    }
+
+    void resize(std::size_t bits) {
+        bits_ = bits;
+        leaves_.assign((bits + 63) / 64, 0);
+        summary_.assign((leaves_.size() + 63) / 64, 0);
+    }
+
+    void set(std::size_t i) {
+        leaves_[i >> 6] |= bit(i);
+        summary_[i >> 12] |= bit(i >> 6);
+    }
+
+    void reset(std::size_t i) {
+        auto& word = leaves_[i >> 6];
+        word &= ~bit(i);
+        if (word == 0) {
+            summary_[i >> 12] &= ~bit(i >> 6);
+        }
+    }
+
+    bool test(std::size_t i) const {
+        return (leaves_[i >> 6] & bit(i)) != 0;
+    }
+
+    bool any() const {
+        return std::any_of(summary_.begin(), summary_.end(), [](uint64_t w) { return w != 0; });
+    }
+
+    void clear() {
+        std::fill(leaves_.begin(), leaves_.end(), 0);
+        std::fill(summary_.begin(), summary_.end(), 0);
+    }
+
+    // First set slot at or after `from`, or npos.
+    std::size_t findNext(std::size_t from) const {
+        if (from >= bits_) {
+            return npos;
+        }
+        const std::size_t leaf = from >> 6;
+        const uint64_t word = leaves_[leaf] & (~uint64_t{0} << (from & 63));
+        if (word != 0) {
+            return (leaf << 6) + static_cast<std::size_t>(std::countr_zero(word));
+        }
+
+        std::size_t next = leaf + 1;
+        for (std::size_t s = next >> 6; s < summary_.size(); ++s) {
+            const uint64_t mask = (s == (next >> 6)) ? (~uint64_t{0} << (next & 63)) : ~uint64_t{0};
+            const uint64_t summary = summary_[s] & mask;
+            if (summary != 0) {
+                const std::size_t found = (s << 6) + static_cast<std::size_t>(std::countr_zero(summary));
+                return (found << 6) + static_cast<std::size_t>(std::countr_zero(leaves_[found]));
+            }
+        }
+        return npos;
+    }
+
+    // Last set slot at or before `from`, or npos.
+    std::size_t findPrev(std::size_t from) const {
+        if (bits_ == 0) {
+            return npos;
+        }
+        from = std::min(from, bits_ - 1);
+        const std::size_t leaf = from >> 6;
+        const uint64_t word = leaves_[leaf] & upToBit(from & 63);
+        if (word != 0) {
+            return (leaf << 6) + 63 - static_cast<std::size_t>(std::countl_zero(word));
+        }
+        if (leaf == 0) {
+            return npos;
+        }
+
+        const std::size_t prev = leaf - 1;
+        for (std::size_t s = (prev >> 6) + 1; s-- > 0;) {
+            const uint64_t mask = (s == (prev >> 6)) ? upToBit(prev & 63) : ~uint64_t{0};
+            const uint64_t summary = summary_[s] & mask;
+            if (summary != 0) {
+                const std::size_t found =
+                    (s << 6) + 63 - static_cast<std::size_t>(std::countl_zero(summary));
+                return (found << 6) + 63 - static_cast<std::size_t>(std::countl_zero(leaves_[found]));
+            }
+        }
+        return npos;
+    }
+
+  private:
+    static uint64_t bit(std::size_t i) {
+        return uint64_t{1} << (i & 63);
+    }
+    static uint64_t upToBit(std::size_t i) {
+        return (i == 63) ? ~uint64_t{0} : ((uint64_t{1} << (i + 1)) - 1);
+    }
+
+    std::size_t bits_ = 0;
+    std::vector<uint64_t> leaves_;
+    std::vector<uint64_t> summary_;
+};
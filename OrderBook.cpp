@@ -2,19 +2,89 @@
 
 #include "Types.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace {
-template <typename mapT> void applySide(mapT& side, const std::vector<Level>& levels) {
+template <typename sideT> sideT makeSide(Price tick, const LevelAllocator& allocator) {
+    if constexpr (requires { typename sideT::OverflowMap; }) {
+        return sideT(tick, sideT::kDefaultCapacity, allocator);
+    } else {
+        return sideT(typename sideT::key_compare{}, allocator);
+    }
+}
+
+template <typename sideT> void applySide(sideT& side, const std::vector<Level>& levels) {
     for (const auto& lvl : levels) {
         if (lvl.qty == 0) {
             side.erase(lvl.price);
             continue;
         }
-        side[lvl.price] = lvl.qty;
+        side.insert_or_assign(lvl.price, lvl.qty);
+    }
+    if constexpr (requires { side.recenter(); }) {
+        side.recenter();
+    }
+}
+
+// Both `side` and the sorted `levels` run best-first under `compare`.
+template <typename sideT, typename Compare>
+void diffSide(const sideT& side, std::vector<Level> levels, Compare compare,
+              std::vector<Level>& out) {
+    std::sort(levels.begin(), levels.end(),
+              [compare](const Level& a, const Level& b) { return compare(a.price, b.price); });
+    auto current = side.begin();
+    auto next = levels.begin();
+    while (current != side.end() || next != levels.end()) {
+        if (next == levels.end() ||
+            (current != side.end() && compare((*current).first, next->price))) {
+            out.push_back(Level{.price = (*current).first, .qty = 0});
+            ++current;
+        } else if (current == side.end() || compare(next->price, (*current).first)) {
+            if (next->qty != 0) {
+                out.push_back(*next);
+            }
+            ++next;
+        } else {
+            if ((*current).second != next->qty) {
+                out.push_back(*next);
+            }
+            ++current;
+            ++next;
+        }
+    }
+}
+
+template <typename sideT> std::optional<Level> bestOf(const sideT& side) {
+    const auto it = side.begin();
+    if (it == side.end()) {
+        return std::nullopt;
+    }
+    const auto [price, qty] = *it;
+    return Level{.price = price, .qty = qty};
+}
+
+template <typename sideT>
+void copyTop(const sideT& side, std::size_t levels, std::vector<Level>& out) {
+    out.clear();
+    for (const auto& [price, qty] : side) {
+        if (out.size() >= levels) {
+            break;
+        }
+        out.push_back(Level{.price = price, .qty = qty});
     }
 }
 } // namespace
 
-void OrderBook::applySnapshot(const OrderBookSnapshot& snapshot) {
+template <typename BidsT, typename AsksT>
+BasicOrderBook<BidsT, AsksT>::BasicOrderBook(Price tick, NodePool::Options poolOptions)
+    : pool_(std::make_shared<NodePool>(poolOptions)),
+      asks_(makeSide<AsksT>(tick, LevelAllocator(pool_))),
+      bids_(makeSide<BidsT>(tick, LevelAllocator(pool_))) {
+}
+
+template <typename BidsT, typename AsksT>
+void BasicOrderBook<BidsT, AsksT>::applySnapshot(const OrderBookSnapshot& snapshot) {
     lastUpdate_ = snapshot.lastUpdate;
     asks_.clear();
     bids_.clear();
@@ -22,20 +92,65 @@ void OrderBook::applySnapshot(const OrderBookSnapshot& snapshot) {
     applySide(bids_, snapshot.bids);
 }
 
-void OrderBook::applyDelta(const OrderBookDelta& delta) {
+template <typename BidsT, typename AsksT>
+void BasicOrderBook<BidsT, AsksT>::applyDelta(const OrderBookDelta& delta) {
     applySide(asks_, delta.asks);
     applySide(bids_, delta.bids);
     lastUpdate_ = delta.lastUpdate;
 }
 
-const BidsMap& OrderBook::getBids() const {
+template <typename BidsT, typename AsksT>
+OrderBookDelta BasicOrderBook<BidsT, AsksT>::diffSnapshot(const OrderBookSnapshot& snapshot) const {
+    OrderBookDelta delta{
+        .firstUpdate = snapshot.lastUpdate,
+        .lastUpdate = snapshot.lastUpdate,
+        .bids = {},
+        .asks = {},
+    };
+    diffSide(asks_, snapshot.asks, std::less<>{}, delta.asks);
+    diffSide(bids_, snapshot.bids, std::greater<>{}, delta.bids);
+    return delta;
+}
+
+template <typename BidsT, typename AsksT>
+const BidsT& BasicOrderBook<BidsT, AsksT>::getBids() const {
     return bids_;
 }
 
-const AsksMap& OrderBook::getAsks() const {
+template <typename BidsT, typename AsksT>
+const AsksT& BasicOrderBook<BidsT, AsksT>::getAsks() const {
     return asks_;
 }
 
-uint64_t OrderBook::getLastUpdate() const {
+template <typename BidsT, typename AsksT>
+uint64_t BasicOrderBook<BidsT, AsksT>::getLastUpdate() const {
     return lastUpdate_;
 }
+
+template <typename BidsT, typename AsksT>
+std::optional<Level> BasicOrderBook<BidsT, AsksT>::bestBid() const {
+    return bestOf(bids_);
+}
+
+template <typename BidsT, typename AsksT>
+std::optional<Level> BasicOrderBook<BidsT, AsksT>::bestAsk() const {
+    return bestOf(asks_);
+}
+
+template <typename BidsT, typename AsksT>
+void BasicOrderBook<BidsT, AsksT>::topBids(std::size_t levels, std::vector<Level>& out) const {
+    copyTop(bids_, levels, out);
+}
+
+template <typename BidsT, typename AsksT>
+void BasicOrderBook<BidsT, AsksT>::topAsks(std::size_t levels, std::vector<Level>& out) const {
+    copyTop(asks_, levels, out);
+}
+
+template <typename BidsT, typename AsksT>
+NodePool::Stats BasicOrderBook<BidsT, AsksT>::poolStats() const {
+    return pool_->stats();
+}
+
+template class BasicOrderBook<BidsMap, AsksMap>;
+template class BasicOrderBook<BidsLadder, AsksLadder>;
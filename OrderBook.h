@@ -1,17 +1,52 @@
 #pragma once
 
+#include "PriceLadder.h"
 #include "Types.h"
 
-class OrderBook {
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+template <typename BidsT, typename AsksT> class BasicOrderBook {
   public:
+    using Bids = BidsT;
+    using Asks = AsksT;
+
+    // `tick` is the price grid in scaled units; backends that do not index by
+    // tick ignore it. Level nodes of both sides come from one NodePool.
+    explicit BasicOrderBook(Price tick = 1, NodePool::Options poolOptions = {});
+
     void applySnapshot(const OrderBookSnapshot& snapshot);
     void applyDelta(const OrderBookDelta& delta);
-    const BidsMap& getBids() const;
-    const AsksMap& getAsks() const;
+    // Levels to change so that applyDelta() of the result leaves the book
+    // equal to `snapshot`: new or resized levels with their quantity,
+    // vanished ones with zero.
+    OrderBookDelta diffSnapshot(const OrderBookSnapshot& snapshot) const;
+    const BidsT& getBids() const;
+    const AsksT& getAsks() const;
     uint64_t getLastUpdate() const;
 
+    std::optional<Level> bestBid() const;
+    std::optional<Level> bestAsk() const;
+    // Fills `out` with up to `levels` best-first levels, reusing its capacity.
+    void topBids(std::size_t levels, std::vector<Level>& out) const;
+    void topAsks(std::size_t levels, std::vector<Level>& out) const;
+    NodePool::Stats poolStats() const;
+
   private:
+    std::shared_ptr<NodePool> pool_;
     uint64_t lastUpdate_ = 0;
-    AsksMap asks_;
-    BidsMap bids_;
+    AsksT asks_;
+    BidsT bids_;
 };
+
+// Sorted-map backend: one tree node per price level.
+using MapOrderBook = BasicOrderBook<BidsMap, AsksMap>;
+// Flat tick-indexed ladder around the touch, far levels in an overflow map.
+using LadderOrderBook = BasicOrderBook<BidsLadder, AsksLadder>;
+
+using OrderBook = LadderOrderBook;
+
+extern template class BasicOrderBook<BidsMap, AsksMap>;
+extern template class BasicOrderBook<BidsLadder, AsksLadder>;
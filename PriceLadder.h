@@ -0,0 +1,321 @@
+#pragma once
+
+#include "OccupancyBitmap.h"
+#include "Types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// One side of the book stored as a flat array of quantities indexed by
+// `(price - anchor) / tick`. The window covers `capacity` ticks around the
+// touch; levels outside it (or off the tick grid) spill to an ordered overflow
+// map. An occupancy bitmap over the window finds the touch and the next
+// non-empty slot with word scans. Iteration merges both stores and yields
+// levels best-first, like the sorted-map sides.
+template <typename Compare> class PriceLadder {
+  public:
+    using OverflowMap = std::map<Price, Qty, Compare, LevelAllocator>;
+
+    static constexpr std::size_t kDefaultCapacity = 4096;
+
+    class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<Price, Qty>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        const_iterator() = default;
+
+        value_type operator*() const {
+            if (fromWindow()) {
+                const std::size_t index = ladder_->indexAt(rank_);
+                return {ladder_->priceAt(index), ladder_->qty_[index]};
+            }
+            return {overflow_->first, overflow_->second};
+        }
+
+        const_iterator& operator++() {
+            if (fromWindow()) {
+                rank_ = ladder_->nextRank(rank_ + 1);
+            } else {
+                ++overflow_;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return rank_ == other.rank_ && overflow_ == other.overflow_;
+        }
+
+      private:
+        friend class PriceLadder;
+
+        const_iterator(const PriceLadder* ladder, std::size_t rank,
+                       typename OverflowMap::const_iterator overflow)
+            : ladder_(ladder), rank_(rank), overflow_(overflow) {
+        }
+
+        bool fromWindow() const {
+            if (rank_ >= ladder_->capacity_) {
+                return false;
+            }
+            if (overflow_ == ladder_->overflow_.end()) {
+                return true;
+            }
+            return Compare{}(ladder_->priceAt(ladder_->indexAt(rank_)), overflow_->first);
+        }
+
+        const PriceLadder* ladder_ = nullptr;
+        std::size_t rank_ = 0;
+        typename OverflowMap::const_iterator overflow_{};
+    };
+
+    explicit PriceLadder(Price tick = 1, std::size_t capacity = kDefaultCapacity,
+                         LevelAllocator allocator = {})
+        : tick_(tick == 0 ? 1 : tick), capacity_(capacity == 0 ? 1 : capacity), qty_(capacity_, 0),
+          occupied_(capacity_), overflow_(Compare{}, std::move(allocator)) {
+    }
+
+    void insert_or_assign(Price price, Qty qty);
+    void erase(Price price);
+    void clear();
+    // Re-anchors the window when the touch has drifted towards either edge.
+    void recenter();
+
+    std::size_t size() const {
+        return count_ + overflow_.size();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    const_iterator begin() const {
+        return const_iterator(this, firstRank(), overflow_.begin());
+    }
+    const_iterator end() const {
+        return const_iterator(this, capacity_, overflow_.end());
+    }
+
+    Price tick() const {
+        return tick_;
+    }
+    std::size_t capacity() const {
+        return capacity_;
+    }
+    std::size_t windowSize() const {
+        return count_;
+    }
+    std::size_t overflowSize() const {
+        return overflow_.size();
+    }
+
+  private:
+    static constexpr bool kDescending = std::is_same_v<Compare, std::greater<>>;
+
+    std::optional<std::size_t> slotOf(Price price) const;
+    Price priceAt(std::size_t index) const {
+        return anchor_ + static_cast<Price>(index) * tick_;
+    }
+    // Rank counts slots best-first: rank 0 is the top of the window for bids
+    // and the bottom of the window for asks.
+    std::size_t indexAt(std::size_t rank) const {
+        return kDescending ? capacity_ - 1 - rank : rank;
+    }
+    std::size_t rankOf(std::size_t index) const {
+        return kDescending ? capacity_ - 1 - index : index;
+    }
+    std::size_t firstRank() const {
+        return count_ == 0 ? capacity_ : rankOf(best_);
+    }
+    std::size_t nextRank(std::size_t rank) const;
+    std::optional<Price> bestPrice() const;
+    void anchorAround(Price touch);
+    void placeInWindow(std::size_t index, Qty qty);
+
+    Price tick_ = 1;
+    std::size_t capacity_ = kDefaultCapacity;
+    bool anchored_ = false;
+    Price anchor_ = 0;
+    std::size_t count_ = 0;
+    std::size_t best_ = 0;
+    std::vector<Qty> qty_;
+    OccupancyBitmap occupied_;
+    OverflowMap overflow_;
+    std::vector<Level> scratch_;
+};
+
+using BidsLadder = PriceLadder<std::greater<>>;
+using AsksLadder = PriceLadder<std::less<>>;
+
+template <typename Compare> void PriceLadder<Compare>::insert_or_assign(Price price, Qty qty) {
+    if (qty == 0) {
+        erase(price);
+        return;
+    }
+    if (!anchored_ && empty()) {
+        anchorAround(price);
+    }
+    if (const auto index = slotOf(price)) {
+        placeInWindow(*index, qty);
+        return;
+    }
+    overflow_.insert_or_assign(price, qty);
+}
+
+template <typename Compare> void PriceLadder<Compare>::erase(Price price) {
+    const auto index = slotOf(price);
+    if (!index) {
+        overflow_.erase(price);
+        return;
+    }
+
+    auto& slot = qty_[*index];
+    if (slot == 0) {
+        return;
+    }
+    slot = 0;
+    occupied_.reset(*index);
+    --count_;
+    if (count_ != 0 && *index == best_) {
+        best_ = indexAt(nextRank(rankOf(best_) + 1));
+    }
+}
+
+template <typename Compare> void PriceLadder<Compare>::clear() {
+    if (count_ != 0) {
+        std::fill(qty_.begin(), qty_.end(), Qty{0});
+        occupied_.clear();
+    }
+    count_ = 0;
+    best_ = 0;
+    anchored_ = false;
+    anchor_ = 0;
+    overflow_.clear();
+}
+
+template <typename Compare> void PriceLadder<Compare>::recenter() {
+    const auto touch = bestPrice();
+    if (!touch || (*touch % tick_) != 0) {
+        // Off-grid touches can never enter the window; leave them in overflow.
+        return;
+    }
+    if (const auto index = slotOf(*touch)) {
+        const std::size_t rank = rankOf(*index);
+        if (rank >= capacity_ / 8 && rank <= capacity_ / 2) {
+            return;
+        }
+    }
+    anchorAround(*touch);
+}
+
+template <typename Compare>
+std::optional<std::size_t> PriceLadder<Compare>::slotOf(Price price) const {
+    if (!anchored_ || price < anchor_) {
+        return std::nullopt;
+    }
+    const Price offset = price - anchor_;
+    if (offset % tick_ != 0) {
+        return std::nullopt;
+    }
+    const Price index = offset / tick_;
+    if (index >= capacity_) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(index);
+}
+
+template <typename Compare> std::size_t PriceLadder<Compare>::nextRank(std::size_t rank) const {
+    if (rank >= capacity_) {
+        return capacity_;
+    }
+    const std::size_t index = indexAt(rank);
+    const std::size_t found = kDescending ? occupied_.findPrev(index) : occupied_.findNext(index);
+    return found == OccupancyBitmap::npos ? capacity_ : rankOf(found);
+}
+
+template <typename Compare> std::optional<Price> PriceLadder<Compare>::bestPrice() const {
+    std::optional<Price> best;
+    if (count_ != 0) {
+        best = priceAt(best_);
+    }
+    if (!overflow_.empty() && (!best || Compare{}(overflow_.begin()->first, *best))) {
+        best = overflow_.begin()->first;
+    }
+    return best;
+}
+
+template <typename Compare> void PriceLadder<Compare>::anchorAround(Price touch) {
+    // Keep a quarter of the window on the better side of the touch so it can
+    // move a few ticks without forcing another re-anchor.
+    const Price headroom = static_cast<Price>(capacity_ / 4);
+    const Price touchTicks = touch / tick_;
+    Price anchorTicks = 0;
+    if constexpr (kDescending) {
+        const Price below = static_cast<Price>(capacity_) - 1 - headroom;
+        anchorTicks = touchTicks > below ? touchTicks - below : 0;
+    } else {
+        anchorTicks = touchTicks > headroom ? touchTicks - headroom : 0;
+    }
+    if (anchored_ && anchor_ == anchorTicks * tick_) {
+        return;
+    }
+
+    scratch_.clear();
+    for (std::size_t index = occupied_.findNext(0); index != OccupancyBitmap::npos;
+         index = occupied_.findNext(index + 1)) {
+        scratch_.push_back(Level{.price = priceAt(index), .qty = qty_[index]});
+        qty_[index] = 0;
+    }
+    occupied_.clear();
+    count_ = 0;
+    best_ = 0;
+    anchored_ = true;
+    anchor_ = anchorTicks * tick_;
+
+    const Price low = anchor_;
+    const Price high = priceAt(capacity_ - 1);
+    auto it = overflow_.lower_bound(kDescending ? high : low);
+    const auto last = overflow_.upper_bound(kDescending ? low : high);
+    while (it != last) {
+        if (const auto index = slotOf(it->first)) {
+            placeInWindow(*index, it->second);
+            it = overflow_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& lvl : scratch_) {
+        if (const auto index = slotOf(lvl.price)) {
+            placeInWindow(*index, lvl.qty);
+        } else {
+            overflow_.insert_or_assign(lvl.price, lvl.qty);
+        }
+    }
+}
+
+template <typename Compare> void PriceLadder<Compare>::placeInWindow(std::size_t index, Qty qty) {
+    auto& slot = qty_[index];
+    if (slot == 0) {
+        occupied_.set(index);
+        if (count_ == 0 || rankOf(index) < rankOf(best_)) {
+            best_ = index;
+        }
+        ++count_;
+    }
+    slot = qty;
+}
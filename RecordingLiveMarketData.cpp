@@ -0,0 +1,27 @@
+#include "RecordingLiveMarketData.h"
+
+#include <utility>
+
+void RecordingLiveMarketData::start(std::string_view symbol, OnText onText) {
+    inner_.start(symbol, [journal = journal_, symbol = std::string(symbol),
+                          onText = std::move(onText)](std::string text) {
+        journal->record(CaptureJournal::RecordType::StreamFrame, symbol, text);
+        onText(std::move(text));
+    });
+}
+
+void RecordingLiveMarketData::startFrames(std::string_view symbol, OnFrame onFrame) {
+    inner_.startFrames(symbol, [journal = journal_, symbol = std::string(symbol),
+                                onFrame = std::move(onFrame)](FrameRef frame) {
+        journal->record(CaptureJournal::RecordType::StreamFrame, symbol, frame.text());
+        onFrame(std::move(frame));
+    });
+}
+
+void RecordingLiveMarketData::stop() {
+    inner_.stop();
+}
+
+void RecordingLiveMarketData::setOnLinkState(OnLinkState onLinkState) {
+    inner_.setOnLinkState(std::move(onLinkState));
+}
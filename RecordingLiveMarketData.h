@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CaptureJournal.h"
+#include "ILiveMarketData.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Forwards to another live source, journaling every frame tagged with the
+// symbol it was started for.
+class RecordingLiveMarketData : public ILiveMarketData {
+  public:
+    RecordingLiveMarketData(ILiveMarketData& inner, std::shared_ptr<CaptureJournal> journal)
+        : inner_(inner), journal_(std::move(journal)) {
+    }
+
+    void start(std::string_view symbol, OnText onText) override final;
+    void startFrames(std::string_view symbol, OnFrame onFrame) override final;
+    void stop() override final;
+    void setOnLinkState(OnLinkState onLinkState) override final;
+
+  private:
+    ILiveMarketData& inner_;
+    const std::shared_ptr<CaptureJournal> journal_;
+};
@@ -12,12 +12,13 @@
 
 namespace {
 struct RenderData {
-    std::vector<std::pair<Price, Qty>> bids;
-    std::vector<std::pair<Price, Qty>> asks;
+    std::vector<Level> bids;
+    std::vector<Level> asks;
     std::string titleLine;
     std::string timeLine;
     std::string depthLine;
     std::string statsLine;
+    std::string latencyLine;
     std::string tableHeader;
     std::string tableSep;
 };
@@ -65,19 +66,6 @@ std::string formatMidPrice(Price bid, Price ask, uint64_t scale) {
     return out.str();
 }
 
-template <typename MapT>
-std::vector<std::pair<Price, Qty>> topLevels(const MapT& side, std::size_t levels) {
-    std::vector<std::pair<Price, Qty>> out;
-    out.reserve(levels);
-    for (const auto& [price, qty] : side) {
-        if (out.size() >= levels) {
-            break;
-        }
-        out.push_back({price, qty});
-    }
-    return out;
-}
-
 std::size_t utf8CodepointCount(std::string_view s) {
     std::size_t count = 0;
     for (unsigned char c : s) {
@@ -120,23 +108,72 @@ std::string buildStatsLine(const OrderBook& book, const BinanceOrderBookSync::Sy
         << "  Levels=" << (book.getBids().size() + book.getAsks().size())
         << "  WS=" << stats.wsMessages << "  Accepted=" << stats.acceptedDeltas
         << "  Dropped=" << stats.droppedDeltas << "  Resyncs=" << stats.resyncs
-        << "  SnapshotRetries=" << stats.snapshotRetries;
+        << "  SnapshotRetries=" << stats.snapshotRetries << "  PoolHW=" << stats.poolHighWater
+        << "  Slabs=" << stats.poolSlabs << "  FirstSyncMs=" << stats.firstSyncMs
+        << "  BootstrapMs=" << stats.lastBootstrapMs << "/" << stats.maxBootstrapMs
+        << "  BufOverflows=" << stats.bootstrapOverflows << "  ReplayUs=" << stats.lastReplayUs
+        << (stats.stale ? "  STALE" : "");
+    if (stats.scalesMissing) {
+        out << "  NOT LISTED";
+    } else if (!stats.hasScales) {
+        out << "  NO SCALES (fetch failures " << stats.scalesFetchFailures << ")";
+    }
+    return out.str();
+}
+
+double toUs(uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+double toMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1'000'000.0;
+}
+
+// p50/p99 per live stage in microseconds; snapshot round trips, resyncs,
+// exchange-side and feed lag and the clock offset in milliseconds.
+std::string buildLatencyLine(const BinanceOrderBookSync::SyncLatency& latency) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "Latency p50/p99 us:";
+    const auto stage = [&out](const char* name, const LatencyHistogram::Percentiles& p) {
+        out << "  " << name << "=" << toUs(p.p50Ns) << "/" << toUs(p.p99Ns);
+    };
+    stage("Dispatch", latency.dispatch);
+    stage("Decode", latency.decode);
+    stage("Apply", latency.apply);
+    stage("Notify", latency.notify);
+    stage("Wire", latency.wire);
+    out << "  SnapshotMs=" << toMs(latency.snapshotRtt.p50Ns) << "/"
+        << toMs(latency.snapshotRtt.p99Ns) << "  ResyncMs=" << toMs(latency.resync.p50Ns) << "/"
+        << toMs(latency.resync.p99Ns) << "  ExchMs=" << toMs(latency.exchange.p50Ns) << "/"
+        << toMs(latency.exchange.p99Ns) << "  FeedMs=" << toMs(latency.feed.p50Ns) << "/"
+        << toMs(latency.feed.p99Ns) << "  ClockOffsetMs="
+        << static_cast<double>(latency.clockOffsetUs) / 1000.0;
     return out.str();
 }
 
+const char* boardState(const BinanceOrderBookSync::SyncStats& stats) {
+    if (stats.scalesMissing) {
+        return "unlisted";
+    }
+    if (!stats.hasScales) {
+        return stats.scalesFetchFailures == 0 ? "wait" : "noscales";
+    }
+    return stats.stale ? "stale" : stats.firstSyncMs == 0 ? "wait" : "live";
+}
+
 std::string buildBookRow(const BinanceAPIParser& formatter,
-                         const std::vector<std::pair<Price, Qty>>& bids,
-                         const std::vector<std::pair<Price, Qty>>& asks, std::size_t i) {
+                         const std::vector<Level>& bids, const std::vector<Level>& asks,
+                         std::size_t i) {
     std::ostringstream out;
     if (i < bids.size()) {
-        out << std::setw(15) << formatter.formatQty(bids[i].second) << "│" << std::setw(12)
-            << formatter.formatPrice(bids[i].first) << "│";
+        out << std::setw(15) << formatter.formatQty(bids[i].qty) << "│" << std::setw(12)
+            << formatter.formatPrice(bids[i].price) << "│";
     } else {
         out << std::setw(15) << "-" << "│" << std::setw(12) << "-" << "│";
     }
     if (i < asks.size()) {
-        out << std::setw(12) << formatter.formatPrice(asks[i].first) << "│" << std::setw(15)
-            << formatter.formatQty(asks[i].second);
+        out << std::setw(12) << formatter.formatPrice(asks[i].price) << "│" << std::setw(15)
+            << formatter.formatQty(asks[i].qty);
     } else {
         out << std::setw(12) << "-" << "│" << std::setw(15) << "-";
     }
@@ -146,18 +183,20 @@ std::string buildBookRow(const BinanceAPIParser& formatter,
 std::size_t computeContentWidth(const RenderData& data) {
     return std::max({utf8CodepointCount(data.tableHeader), utf8CodepointCount(data.tableSep),
                      utf8CodepointCount(data.titleLine), utf8CodepointCount(data.timeLine),
-                     utf8CodepointCount(data.depthLine), utf8CodepointCount(data.statsLine)});
+                     utf8CodepointCount(data.depthLine), utf8CodepointCount(data.statsLine),
+                     utf8CodepointCount(data.latencyLine)});
 }
 
 RenderData makeRenderData(const OrderBook& book, const BinanceOrderBookSync::SyncStats& stats,
                           std::string_view symbol, std::size_t levels) {
     RenderData data;
-    data.bids = topLevels(book.getBids(), levels);
-    data.asks = topLevels(book.getAsks(), levels);
+    book.topBids(levels, data.bids);
+    book.topAsks(levels, data.asks);
     data.titleLine = "LIVE ORDERBOOK  " + std::string(symbol);
     data.timeLine = nowString();
     data.depthLine = "Depth: " + std::to_string(levels);
     data.statsLine = buildStatsLine(book, stats);
+    data.latencyLine = buildLatencyLine(stats.latency);
     data.tableHeader = buildTableHeader();
     data.tableSep = repeatUtf8("─", 15) + "┼" + repeatUtf8("─", 12) + "┼" + repeatUtf8("─", 12) +
                     "┼" + repeatUtf8("─", 15);
@@ -165,34 +204,74 @@ RenderData makeRenderData(const OrderBook& book, const BinanceOrderBookSync::Syn
 }
 
 void printSummary(const BinanceAPIParser& formatter, uint64_t priceScale,
-                  const std::vector<std::pair<Price, Qty>>& bids,
-                  const std::vector<std::pair<Price, Qty>>& asks,
+                  const std::vector<Level>& bids, const std::vector<Level>& asks,
                   const std::function<void(const std::string&)>& printLine) {
     if (bids.empty() || asks.empty()) {
         return;
     }
 
-    const Price spreadTicks = asks.front().first - bids.front().first;
-    const std::string midPrice = formatMidPrice(bids.front().first, asks.front().first, priceScale);
+    const Price spreadTicks = asks.front().price - bids.front().price;
+    const std::string midPrice = formatMidPrice(bids.front().price, asks.front().price, priceScale);
     const double midPriceForBps =
-        (static_cast<double>(bids.front().first + asks.front().first) / 2.0) /
+        (static_cast<double>(bids.front().price + asks.front().price) / 2.0) /
         static_cast<double>(priceScale);
-    const double spreadForBps = static_cast<double>(asks.front().first - bids.front().first) /
+    const double spreadForBps = static_cast<double>(asks.front().price - bids.front().price) /
                                 static_cast<double>(priceScale);
     const double spreadBps =
         (midPriceForBps == 0.0) ? 0.0 : (spreadForBps / midPriceForBps) * 10000.0;
 
     std::ostringstream spreadOut;
     spreadOut << std::fixed << std::setprecision(1) << spreadBps;
-    printLine("Best Bid : $" + formatter.formatPrice(bids.front().first));
-    printLine("Best Ask : $" + formatter.formatPrice(asks.front().first));
+    printLine("Best Bid : $" + formatter.formatPrice(bids.front().price));
+    printLine("Best Ask : $" + formatter.formatPrice(asks.front().price));
     printLine("Spread   : $" + formatter.formatPrice(spreadTicks) + " (" + spreadOut.str() +
               " bps)");
     printLine("Mid Price: $" + midPrice);
 }
+
+// Reconnects with their mean/max time to recover, then per redundant feed
+// the share of updates it delivered first and its lag behind the winner.
+std::vector<std::string> buildConnectionLines(const MultiSymbolEngine::ConnectionStats& connection) {
+    std::vector<std::string> lines;
+    const auto& link = connection.link;
+    if (link.disconnects != 0) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << "Link: Disconnects=" << link.disconnects
+            << "  WatchdogTrips=" << link.watchdogTrips << "  Recovered=" << link.recoveries
+            << "  MttrMs="
+            << (link.recoveries == 0 ? 0.0
+                                     : static_cast<double>(link.totalRecoveryMs) /
+                                           static_cast<double>(link.recoveries))
+            << "  MaxRecoveryMs=" << link.maxRecoveryMs;
+        lines.push_back(out.str());
+    }
+
+    const auto& feeds = connection.feeds;
+    uint64_t total = 0;
+    for (const auto& feed : feeds) {
+        total += feed.wins;
+    }
+    for (std::size_t i = 0; i < feeds.size(); ++i) {
+        const auto& feed = feeds[i];
+        const double winRate = total == 0 ? 0.0 : 100.0 * static_cast<double>(feed.wins) /
+                                                      static_cast<double>(total);
+        const double avgLagMs = feed.lagSamples == 0
+                                    ? 0.0
+                                    : static_cast<double>(feed.totalLagUs) /
+                                          static_cast<double>(feed.lagSamples) / 1000.0;
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << "Feed " << i << ": Wins=" << winRate
+            << "%  LagAvgMs=" << avgLagMs
+            << "  LagMaxMs=" << static_cast<double>(feed.maxLagUs) / 1000.0
+            << "  Held=" << feed.held << "  Frames=" << feed.frames;
+        lines.push_back(out.str());
+    }
+    return lines;
+}
 } // namespace
 
-void Renderer::render(const OrderBook& book, const BinanceOrderBookSync::SyncStats& stats) {
+void Renderer::render(const OrderBook& book, const BinanceOrderBookSync::SyncStats& stats,
+                      const MultiSymbolEngine::ConnectionStats& connection) {
     std::cout << "\x1b[2J\x1b[H";
 
     const RenderData data = makeRenderData(book, stats, symbol_, levels_);
@@ -218,6 +297,44 @@ void Renderer::render(const OrderBook& book, const BinanceOrderBookSync::SyncSta
 
     printLine("");
     printLine(data.statsLine);
+    printLine(data.latencyLine);
+    for (const auto& line : buildConnectionLines(connection)) {
+        printLine(line);
+    }
 
     std::cout.flush();
 }
+
+void BoardRenderer::render(const std::vector<BoardRow>& rows,
+                           const MultiSymbolEngine::ConnectionStats& connection) {
+    std::cout << "\x1b[2J\x1b[H";
+    std::cout << "LIVE ORDERBOOKS  " << rows.size() << " symbols\n" << nowString() << "\n\n";
+    std::cout << std::left << std::setw(14) << "SYMBOL" << std::right << std::setw(16) << "BID"
+              << std::setw(16) << "ASK" << std::setw(12) << "WS" << std::setw(12) << "Accepted"
+              << std::setw(10) << "Dropped" << std::setw(9) << "Resyncs" << std::setw(14)
+              << "FirstSyncMs" << std::setw(12) << "WireP99us" << std::setw(10) << "State"
+              << "\n";
+
+    const auto formatSide = [](const std::optional<Level>& level, uint64_t scale) {
+        return level ? BinanceAPIParser::formatScaled(level->price, scale) : std::string("-");
+    };
+    for (const auto& row : rows) {
+        std::cout << std::left << std::setw(14) << row.symbol << std::right << std::setw(16)
+                  << formatSide(row.bestBid, row.scales.priceScale) << std::setw(16)
+                  << formatSide(row.bestAsk, row.scales.priceScale) << std::setw(12)
+                  << row.stats.wsMessages << std::setw(12) << row.stats.acceptedDeltas
+                  << std::setw(10) << row.stats.droppedDeltas << std::setw(9)
+                  << row.stats.resyncs << std::setw(14) << row.stats.firstSyncMs << std::setw(12)
+                  << std::fixed << std::setprecision(1) << toUs(row.stats.latency.wire.p99Ns)
+                  << std::setw(10) << boardState(row.stats)
+                  << "\n";
+    }
+    const auto connectionLines = buildConnectionLines(connection);
+    if (!connectionLines.empty()) {
+        std::cout << "\n";
+    }
+    for (const auto& line : connectionLines) {
+        std::cout << line << "\n";
+    }
+    std::cout.flush();
+}
@@ -2,11 +2,15 @@
 
 #include "BinanceAPIParser.h"
 #include "BinanceOrderBookSync.h"
+#include "MultiSymbolEngine.h"
 #include "OrderBook.h"
 #include "Types.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
 
 class Renderer {
   public:
@@ -14,7 +18,8 @@ class Renderer {
         : scales_(scales), formatter_(scales), symbol_(std::move(symbol)), levels_(levels) {
     }
 
-    void render(const OrderBook& book, const BinanceOrderBookSync::SyncStats& stats);
+    void render(const OrderBook& book, const BinanceOrderBookSync::SyncStats& stats,
+                const MultiSymbolEngine::ConnectionStats& connection = {});
 
   private:
     SymbolScales scales_;
@@ -22,3 +27,20 @@ class Renderer {
     std::string symbol_;
     std::size_t levels_;
 };
+
+struct BoardRow {
+    std::string symbol;
+    SymbolScales scales{};
+    std::optional<Level> bestBid;
+    std::optional<Level> bestAsk;
+    uint64_t lastUpdate = 0;
+    BinanceOrderBookSync::SyncStats stats{};
+};
+
+// One line per symbol, for multi-symbol runs where a full ladder per book
+// does not fit on screen.
+class BoardRenderer {
+  public:
+    void render(const std::vector<BoardRow>& rows,
+                const MultiSymbolEngine::ConnectionStats& connection = {});
+};
@@ -0,0 +1,40 @@
+#include "RequestWeightBudget.h"
+
+#include <algorithm>
+
+RequestWeightBudget::RequestWeightBudget(uint64_t weightPerMinute, uint64_t reserve)
+    : weightPerMinute_(static_cast<double>(weightPerMinute)),
+      reserve_(static_cast<double>(reserve)),
+      available_(static_cast<double>(weightPerMinute)),
+      refilledAt_(std::chrono::steady_clock::now()) {
+}
+
+void RequestWeightBudget::charge(uint64_t weight) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill();
+    // May go negative: the request is sent anyway and the debt delays hedges.
+    available_ -= static_cast<double>(weight);
+}
+
+bool RequestWeightBudget::tryAcquire(uint64_t weight) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill();
+    if (available_ - static_cast<double>(weight) < reserve_) {
+        return false;
+    }
+    available_ -= static_cast<double>(weight);
+    return true;
+}
+
+int64_t RequestWeightBudget::available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill();
+    return static_cast<int64_t>(available_);
+}
+
+void RequestWeightBudget::refill() {
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::ratio<60>> elapsed = now - refilledAt_;
+    refilledAt_ = now;
+    available_ = std::min(weightPerMinute_, available_ + elapsed.count() * weightPerMinute_);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Token bucket over an exchange's per-minute request weight limit, shared
+// by everything that talks to the same REST host from this IP. Required
+// requests are charged unconditionally; optional ones (hedges) only go out
+// while `reserve` weight would remain afterwards. Thread-safe.
+class RequestWeightBudget {
+  public:
+    RequestWeightBudget(uint64_t weightPerMinute, uint64_t reserve);
+
+    void charge(uint64_t weight);
+    bool tryAcquire(uint64_t weight);
+    int64_t available();
+
+  private:
+    void refill();
+
+    const double weightPerMinute_;
+    const double reserve_;
+    std::mutex mutex_;
+    double available_;
+    std::chrono::steady_clock::time_point refilledAt_;
+};
@@ -0,0 +1,295 @@
+#include "ScaledDecimal.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SCALED_DECIMAL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+bool parseBatchScalar(const std::string_view* text, uint64_t* out, std::size_t count,
+                      uint64_t scale, uint32_t places) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto value = ScaledDecimal::parse(text[i], scale, places);
+        if (!value) {
+            return false;
+        }
+        out[i] = *value;
+    }
+    return true;
+}
+
+#if defined(SCALED_DECIMAL_X86)
+// The vector path packs a value into one 16-byte register as two 8-digit
+// halves: the integer part right-aligned in bytes [0, 8) and the fraction,
+// padded with zeros to `places` digits, right-aligned in bytes [8, 16).
+// A maddubs/madd/packus/madd chain then yields both halves as u32.
+constexpr std::size_t kLanes = 16;
+constexpr std::size_t kHalf = 8;
+constexpr uint8_t kZeroLane = 0x80;
+
+struct ShuffleTables {
+    // intMask[len]: bytes [8 - len, 8) take input bytes [0, len).
+    alignas(16) uint8_t intMask[kHalf + 1][kLanes];
+    // fracMask[places][len]: bytes [16 - places, 16 - places + len) take
+    // input bytes [0, len); the caller adds the fraction's start offset.
+    alignas(16) uint8_t fracMask[kHalf + 1][kHalf + 1][kLanes];
+};
+
+constexpr ShuffleTables makeShuffleTables() {
+    ShuffleTables tables{};
+    for (std::size_t len = 0; len <= kHalf; ++len) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            const bool inside = lane >= kHalf - len && lane < kHalf;
+            tables.intMask[len][lane] =
+                inside ? static_cast<uint8_t>(lane - (kHalf - len)) : kZeroLane;
+        }
+    }
+    for (std::size_t places = 0; places <= kHalf; ++places) {
+        for (std::size_t len = 0; len <= places; ++len) {
+            const std::size_t first = kLanes - places;
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                const bool inside = lane >= first && lane < first + len;
+                tables.fracMask[places][len][lane] =
+                    inside ? static_cast<uint8_t>(lane - first) : kZeroLane;
+            }
+        }
+    }
+    return tables;
+}
+
+constexpr ShuffleTables kTables = makeShuffleTables();
+
+__attribute__((target("sse4.1"))) bool prepareDigits(std::string_view s, uint32_t places,
+                                                     __m128i& digits) {
+    const std::size_t n = s.size();
+    if (n == 0 || n > kLanes || places > kHalf) {
+        return false;
+    }
+
+    __m128i raw;
+    const auto address = reinterpret_cast<std::uintptr_t>(s.data());
+    if ((address & 4095) <= 4096 - kLanes) {
+        // Over-reading within the same page is safe; the extra bytes are
+        // never selected by the shuffle masks below.
+        raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()));
+    } else {
+        alignas(16) char buffer[kLanes] = {};
+        std::memcpy(buffer, s.data(), n);
+        raw = _mm_load_si128(reinterpret_cast<const __m128i*>(buffer));
+    }
+
+    const unsigned inRange = (n == kLanes) ? 0xFFFFu : ((1u << n) - 1);
+    const unsigned dots =
+        static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(raw, _mm_set1_epi8('.')))) &
+        inRange;
+    const std::size_t dot = dots ? static_cast<std::size_t>(std::countr_zero(dots)) : n;
+    const std::size_t fracStart = dot < n ? dot + 1 : n;
+    const std::size_t fracLen = std::min<std::size_t>(n - fracStart, places);
+    if (dot == 0 || dot > kHalf) {
+        return false;
+    }
+
+    const __m128i intMask =
+        _mm_load_si128(reinterpret_cast<const __m128i*>(kTables.intMask[dot]));
+    const __m128i fracMask = _mm_add_epi8(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(kTables.fracMask[places][fracLen])),
+        _mm_set1_epi8(static_cast<char>(fracStart)));
+    const __m128i mask = _mm_min_epu8(intMask, fracMask);
+    digits = _mm_shuffle_epi8(_mm_sub_epi8(raw, _mm_set1_epi8('0')), mask);
+
+    const __m128i nine = _mm_set1_epi8(9);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) == 0xFFFF;
+}
+
+bool combine(uint64_t intValue, uint64_t fracValue, uint64_t scale, uint64_t& out) {
+    if (intValue > (std::numeric_limits<uint64_t>::max() - fracValue) / scale) {
+        return false;
+    }
+    out = intValue * scale + fracValue;
+    return true;
+}
+
+__attribute__((target("sse4.1"))) bool convertSse41(std::string_view s, uint64_t scale,
+                                                    uint32_t places, uint64_t& out) {
+    __m128i digits;
+    if (!prepareDigits(s, places, digits)) {
+        return false;
+    }
+    const __m128i pairs = _mm_maddubs_epi16(digits, _mm_set1_epi16(0x010A));
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));
+    const __m128i packed = _mm_packus_epi32(quads, quads);
+    const __m128i halves = _mm_madd_epi16(packed, _mm_set1_epi32(0x00012710));
+    const auto intValue = static_cast<uint64_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(halves)));
+    const auto fracValue = static_cast<uint64_t>(static_cast<uint32_t>(_mm_extract_epi32(halves, 1)));
+    return combine(intValue, fracValue, scale, out);
+}
+
+__attribute__((target("sse4.1"))) bool parseBatchSse41(const std::string_view* text, uint64_t* out,
+                                                       std::size_t count, uint64_t scale,
+                                                       uint32_t places) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!convertSse41(text[i], scale, places, out[i]) &&
+            !parseBatchScalar(text + i, out + i, 1, scale, places)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2"))) bool parseBatchAvx2(const std::string_view* text, uint64_t* out,
+                                                    std::size_t count, uint64_t scale,
+                                                    uint32_t places) {
+    std::size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        __m128i first;
+        __m128i second;
+        if (!prepareDigits(text[i], places, first) || !prepareDigits(text[i + 1], places, second)) {
+            if (!parseBatchSse41(text + i, out + i, 2, scale, places)) {
+                return false;
+            }
+            continue;
+        }
+        // Two values per register, one per 128-bit lane.
+        const __m256i digits = _mm256_set_m128i(second, first);
+        const __m256i pairs = _mm256_maddubs_epi16(digits, _mm256_set1_epi16(0x010A));
+        const __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00010064));
+        const __m256i packed = _mm256_packus_epi32(quads, quads);
+        const __m256i halves = _mm256_madd_epi16(packed, _mm256_set1_epi32(0x00012710));
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), halves);
+        if ((!combine(lanes[0], lanes[1], scale, out[i]) &&
+             !parseBatchScalar(text + i, out + i, 1, scale, places)) ||
+            (!combine(lanes[4], lanes[5], scale, out[i + 1]) &&
+             !parseBatchScalar(text + i + 1, out + i + 1, 1, scale, places))) {
+            return false;
+        }
+    }
+    return parseBatchSse41(text + i, out + i, count - i, scale, places);
+}
+#endif
+} // namespace
+
+std::optional<uint32_t> ScaledDecimal::placesFromScale(uint64_t scale) {
+    if (scale == 0) {
+        return std::nullopt;
+    }
+    uint32_t places = 0;
+    while (scale > 1) {
+        if ((scale % 10) != 0) {
+            return std::nullopt;
+        }
+        scale /= 10;
+        ++places;
+    }
+    return places;
+}
+
+std::optional<uint64_t> ScaledDecimal::parseUint(std::string_view s) {
+    if (s.empty()) {
+        return std::nullopt;
+    }
+    uint64_t out = 0;
+    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    if (ec != std::errc() || ptr != s.data() + s.size()) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+std::optional<uint64_t> ScaledDecimal::parse(std::string_view s, uint64_t scale, uint32_t places) {
+    const size_t dot = s.find('.');
+    const std::string_view intPart = (dot == std::string_view::npos) ? s : s.substr(0, dot);
+    std::string_view fracPart =
+        (dot == std::string_view::npos) ? std::string_view{} : s.substr(dot + 1);
+
+    if (intPart.empty()) {
+        return std::nullopt;
+    }
+
+    const auto intValue = parseUint(intPart);
+    if (!intValue) {
+        return std::nullopt;
+    }
+
+    if (fracPart.size() > places) {
+        // Be tolerant when payload has finer precision than configured scale.
+        // Keep the supported precision and drop excess fractional digits.
+        fracPart = fracPart.substr(0, places);
+    }
+
+    uint64_t fracValue = 0;
+    if (!fracPart.empty()) {
+        const auto parsedFrac = parseUint(fracPart);
+        if (!parsedFrac) {
+            return std::nullopt;
+        }
+        fracValue = *parsedFrac;
+    }
+
+    for (size_t i = fracPart.size(); i < places; ++i) {
+        if (fracValue > std::numeric_limits<uint64_t>::max() / 10) {
+            return std::nullopt;
+        }
+        fracValue *= 10;
+    }
+
+    if (*intValue > (std::numeric_limits<uint64_t>::max() - fracValue) / scale) {
+        return std::nullopt;
+    }
+    return (*intValue * scale) + fracValue;
+}
+
+bool ScaledDecimal::parseBatch(const std::string_view* text, uint64_t* out, std::size_t count,
+                               uint64_t scale, uint32_t places) {
+    static const Kernel kernel = bestKernel();
+    return parseBatch(kernel, text, out, count, scale, places);
+}
+
+bool ScaledDecimal::parseBatch(Kernel kernel, const std::string_view* text, uint64_t* out,
+                               std::size_t count, uint64_t scale, uint32_t places) {
+    if (scale == 0) {
+        return false;
+    }
+    switch (kernel) {
+#if defined(SCALED_DECIMAL_X86)
+    case Kernel::Avx2:
+        return parseBatchAvx2(text, out, count, scale, places);
+    case Kernel::Sse41:
+        return parseBatchSse41(text, out, count, scale, places);
+#endif
+    default:
+        return parseBatchScalar(text, out, count, scale, places);
+    }
+}
+
+ScaledDecimal::Kernel ScaledDecimal::bestKernel() {
+#if defined(SCALED_DECIMAL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Kernel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Kernel::Sse41;
+    }
+#endif
+    return Kernel::Scalar;
+}
+
+const char* ScaledDecimal::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Avx2:
+        return "avx2";
+    case Kernel::Sse41:
+        return "sse4.1";
+    case Kernel::Scalar:
+        break;
+    }
+    return "scalar";
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Fixed-point conversion for the exchange's decimal strings. Values are
+// scaled by a power of ten (`scale`, with `places` fractional digits).
+class ScaledDecimal {
+  public:
+    enum class Kernel {
+        Scalar,
+        Sse41,
+        Avx2,
+    };
+
+    static std::optional<uint32_t> placesFromScale(uint64_t scale);
+    static std::optional<uint64_t> parseUint(std::string_view s);
+    static std::optional<uint64_t> parse(std::string_view s, uint64_t scale, uint32_t places);
+
+    // Converts `count` strings sharing one scale into `out`. Returns false if
+    // any of them is not a valid decimal. Uses the widest SIMD kernel the CPU
+    // supports; values the vector path cannot represent go through parse().
+    static bool parseBatch(const std::string_view* text, uint64_t* out, std::size_t count,
+                           uint64_t scale, uint32_t places);
+    static bool parseBatch(Kernel kernel, const std::string_view* text, uint64_t* out,
+                           std::size_t count, uint64_t scale, uint32_t places);
+    static Kernel bestKernel();
+    static const char* kernelName(Kernel kernel);
+};
@@ -0,0 +1,175 @@
+#include "ScalesCache.h"
+
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+constexpr std::string_view kHeader = "orderbook-scales v1";
+constexpr std::string_view kFetchedKey = "fetched ";
+constexpr std::string_view kChecksumKey = "checksum ";
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t checksum(std::string_view text) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (const unsigned char c : text) {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Positive decimal such as "0.10" or "1".
+bool isStepValue(std::string_view value) {
+    bool digit = false;
+    bool dot = false;
+    for (const char c : value) {
+        if (c >= '0' && c <= '9') {
+            digit = true;
+        } else if (c == '.' && !dot) {
+            dot = true;
+        } else {
+            return false;
+        }
+    }
+    return digit;
+}
+
+std::optional<int64_t> parseInt(std::string_view text) {
+    int64_t value = 0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// `SYMBOL tickSize stepSize pricePrecision quantityPrecision`, with -1 for
+// an absent precision.
+bool parseEntry(const std::string& line, std::string& symbol, SymbolFilters& filters) {
+    std::istringstream in(line);
+    std::string price;
+    std::string quantity;
+    std::string extra;
+    if (!(in >> symbol >> filters.tickSize >> filters.stepSize >> price >> quantity) ||
+        (in >> extra)) {
+        return false;
+    }
+    const auto pricePrecision = parseInt(price);
+    const auto quantityPrecision = parseInt(quantity);
+    if (!pricePrecision || !quantityPrecision || !isStepValue(filters.tickSize) ||
+        !isStepValue(filters.stepSize)) {
+        return false;
+    }
+    filters.pricePrecision =
+        *pricePrecision < 0 ? std::nullopt : std::optional<int64_t>(*pricePrecision);
+    filters.quantityPrecision =
+        *quantityPrecision < 0 ? std::nullopt : std::optional<int64_t>(*quantityPrecision);
+    return true;
+}
+} // namespace
+
+ScalesCache::FiltersBySymbol ScalesCache::load() const {
+    if (!enabled()) {
+        return {};
+    }
+    std::ifstream file(path_);
+    if (!file) {
+        return {};
+    }
+
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(std::move(line));
+    }
+    if (lines.size() < 3 || lines.front() != kHeader ||
+        !lines[1].starts_with(kFetchedKey) || !lines.back().starts_with(kChecksumKey)) {
+        return {};
+    }
+
+    std::string body;
+    for (std::size_t i = 0; i + 1 < lines.size(); ++i) {
+        body += lines[i];
+        body += '\n';
+    }
+    const std::string_view storedChecksum =
+        std::string_view(lines.back()).substr(kChecksumKey.size());
+    uint64_t expected = 0;
+    const auto [end, ec] = std::from_chars(storedChecksum.data(),
+                                           storedChecksum.data() + storedChecksum.size(),
+                                           expected, 16);
+    if (ec != std::errc{} || end != storedChecksum.data() + storedChecksum.size() ||
+        expected != checksum(body)) {
+        std::cerr << "ScalesCache ignoring corrupt cache " << path_ << '\n';
+        return {};
+    }
+
+    const auto fetched = parseInt(std::string_view(lines[1]).substr(kFetchedKey.size()));
+    if (!fetched || nowSeconds() - *fetched > ttl_.count() || *fetched > nowSeconds() + 60) {
+        return {};
+    }
+
+    FiltersBySymbol out;
+    for (std::size_t i = 2; i + 1 < lines.size(); ++i) {
+        std::string symbol;
+        SymbolFilters filters;
+        if (!parseEntry(lines[i], symbol, filters)) {
+            std::cerr << "ScalesCache ignoring corrupt cache " << path_ << '\n';
+            return {};
+        }
+        out.emplace(std::move(symbol), std::move(filters));
+    }
+    return out;
+}
+
+bool ScalesCache::store(const FiltersBySymbol& filters) const {
+    if (!enabled()) {
+        return false;
+    }
+
+    std::ostringstream body;
+    body << kHeader << '\n' << kFetchedKey << nowSeconds() << '\n';
+    for (const auto& [symbol, entry] : filters) {
+        body << symbol << ' ' << entry.tickSize << ' ' << entry.stepSize << ' '
+             << entry.pricePrecision.value_or(-1) << ' ' << entry.quantityPrecision.value_or(-1)
+             << '\n';
+    }
+    const std::string text = body.str();
+
+    const std::string tmpPath = path_ + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "ScalesCache cannot write " << tmpPath << '\n';
+            return false;
+        }
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(checksum(text)));
+        file << text << kChecksumKey << hex << '\n';
+        if (!file.flush()) {
+            std::cerr << "ScalesCache cannot write " << tmpPath << '\n';
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path_, ec);
+    if (ec) {
+        std::cerr << "ScalesCache cannot replace " << path_ << ": " << ec.message() << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+// The exchangeInfo fields scales are derived from, kept verbatim so cached
+// entries go through exactly the same derivation as fresh ones.
+struct SymbolFilters {
+    std::string tickSize;
+    std::string stepSize;
+    std::optional<int64_t> pricePrecision;
+    std::optional<int64_t> quantityPrecision;
+
+    bool operator==(const SymbolFilters&) const = default;
+};
+
+// On-disk cache of SymbolFilters for every symbol of one exchangeInfo fetch.
+// The file is versioned text with a fetch timestamp and a trailing checksum;
+// a missing, expired, truncated or otherwise invalid file loads as empty.
+class ScalesCache {
+  public:
+    using FiltersBySymbol = std::map<std::string, SymbolFilters>;
+
+    ScalesCache() = default;
+    ScalesCache(std::string path, std::chrono::seconds ttl)
+        : path_(std::move(path)), ttl_(ttl) {
+    }
+
+    bool enabled() const {
+        return !path_.empty();
+    }
+
+    FiltersBySymbol load() const;
+    // Writes to a temporary file and renames it over the cache.
+    bool store(const FiltersBySymbol& filters) const;
+
+  private:
+    std::string path_;
+    std::chrono::seconds ttl_{0};
+};
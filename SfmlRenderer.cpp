@@ -2,6 +2,7 @@
 
 #include <SFML/Graphics.hpp>
 #include <algorithm>
+#include <iomanip>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -20,7 +21,32 @@ std::string statsLine(const SfmlBookFrame& frame) {
     out << "lastUpdate=" << frame.lastUpdate << "   ws=" << frame.stats.wsMessages
         << "   accepted=" << frame.stats.acceptedDeltas
         << "   dropped=" << frame.stats.droppedDeltas << "   resync=" << frame.stats.resyncs
-        << "   snapRetry=" << frame.stats.snapshotRetries;
+        << "   snapRetry=" << frame.stats.snapshotRetries
+        << "   firstSyncMs=" << frame.stats.firstSyncMs << (frame.stats.stale ? "   STALE" : "");
+    if (frame.stats.scalesMissing) {
+        out << "   NOT LISTED";
+    } else if (!frame.stats.hasScales) {
+        out << "   NO SCALES (fetch failures " << frame.stats.scalesFetchFailures << ")";
+    }
+
+    // p50/p99 of each live stage, in microseconds.
+    const auto& latency = frame.stats.latency;
+    const auto stage = [&out](const char* name, const LatencyHistogram::Percentiles& p) {
+        out << "   " << name << "=" << static_cast<double>(p.p50Ns) / 1000.0 << "/"
+            << static_cast<double>(p.p99Ns) / 1000.0;
+    };
+    out << std::fixed << std::setprecision(1) << "\nus p50/p99:";
+    stage("dispatch", latency.dispatch);
+    stage("decode", latency.decode);
+    stage("apply", latency.apply);
+    stage("notify", latency.notify);
+    stage("wire", latency.wire);
+    out << "   snapshotMs=" << static_cast<double>(latency.snapshotRtt.p50Ns) / 1e6 << "/"
+        << static_cast<double>(latency.snapshotRtt.p99Ns) / 1e6;
+    out << "   resyncMs=" << static_cast<double>(latency.resync.p50Ns) / 1e6 << "/"
+        << static_cast<double>(latency.resync.p99Ns) / 1e6;
+    out << "   feedMs=" << static_cast<double>(latency.feed.p50Ns) / 1e6 << "/"
+        << static_cast<double>(latency.feed.p99Ns) / 1e6;
     return out.str();
 }
 
@@ -82,7 +108,7 @@ void applyLayout(const sf::RenderWindow& window, std::size_t levels, Layout& lay
     const float height = static_cast<float>(size.y);
     const float margin = std::max(14.f, width * 0.02f);
     const float headerTop = std::max(14.f, height * 0.02f);
-    const float afterHeaderY = headerTop + 86.f;
+    const float afterHeaderY = headerTop + 106.f;
     const float bottomMargin = std::max(12.f, height * 0.02f);
     layout.rowHeight =
         std::max(22.f, (height - afterHeaderY - bottomMargin) / static_cast<float>(levels));
@@ -0,0 +1,93 @@
+#include "ShardedRuntime.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <iostream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+} // namespace
+
+ShardedRuntime::ShardedRuntime(Options options)
+    : options_(options) {
+    if (options_.shards == 0) {
+        options_.shards = std::max(1U, std::thread::hardware_concurrency());
+    }
+    shards_.reserve(options_.shards);
+    for (std::size_t i = 0; i < options_.shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+ShardedRuntime::~ShardedRuntime() {
+    stop();
+    join();
+}
+
+void ShardedRuntime::start() {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        auto& shard = *shards_[i];
+        if (shard.thread.joinable()) {
+            continue;
+        }
+        shard.thread = std::thread([this, i, &shard]() {
+            if (options_.pinThreads) {
+                pinCurrentThread(i);
+            }
+            try {
+                shard.io.run();
+            } catch (const std::exception& e) {
+                std::cerr << "ShardedRuntime shard " << i << " stopped: " << e.what() << '\n';
+            }
+        });
+    }
+}
+
+void ShardedRuntime::stop() {
+    for (auto& shard : shards_) {
+        shard->work.reset();
+        shard->io.stop();
+    }
+}
+
+void ShardedRuntime::join() {
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+std::size_t ShardedRuntime::shardFor(std::string_view symbol) const {
+    return static_cast<std::size_t>(stableHash(symbol) % shards_.size());
+}
+
+uint64_t ShardedRuntime::stableHash(std::string_view symbol) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (const unsigned char c : symbol) {
+        hash ^= static_cast<uint64_t>(std::toupper(c));
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+void ShardedRuntime::pinCurrentThread(std::size_t shardIndex) const {
+#if defined(__linux__)
+    const std::size_t cores = std::max(1U, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((options_.firstCore + shardIndex) % cores, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "ShardedRuntime could not pin shard " << shardIndex << '\n';
+    }
+#else
+    (void)shardIndex;
+#endif
+}
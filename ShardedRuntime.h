@@ -0,0 +1,64 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Thread-per-core runtime: N single-threaded io_contexts, each driven by
+// its own thread and optionally pinned to one core. Symbols map to shards
+// by a stable hash, so everything for a symbol (socket reads, parsing,
+// sequencing, book mutation) runs on one core without cross-thread handoff.
+class ShardedRuntime {
+  public:
+    struct Options {
+        // 0 picks std::thread::hardware_concurrency().
+        std::size_t shards = 1;
+        bool pinThreads = false;
+        // Shard i is pinned to core (firstCore + i) modulo the core count.
+        std::size_t firstCore = 0;
+    };
+
+    ShardedRuntime()
+        : ShardedRuntime(Options{}) {
+    }
+    explicit ShardedRuntime(Options options);
+    ShardedRuntime(const ShardedRuntime&) = delete;
+    ShardedRuntime& operator=(const ShardedRuntime&) = delete;
+    ~ShardedRuntime();
+
+    void start();
+    void stop();
+    void join();
+
+    std::size_t shardCount() const {
+        return shards_.size();
+    }
+    boost::asio::io_context& shard(std::size_t index) {
+        return shards_[index]->io;
+    }
+    std::size_t shardFor(std::string_view symbol) const;
+
+    // FNV-1a over the uppercased symbol; identical across runs and builds.
+    static uint64_t stableHash(std::string_view symbol);
+
+  private:
+    struct Shard {
+        Shard()
+            : io(1), work(boost::asio::make_work_guard(io)) {
+        }
+
+        boost::asio::io_context io;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+        std::thread thread;
+    };
+
+    void pinCurrentThread(std::size_t shardIndex) const;
+
+    Options options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
@@ -1,16 +1,25 @@
 #pragma once
+#include "NodePool.h"
+
+#include <chrono>
 #include <cstdint>
 #include <map>
+#include <utility>
 #include <vector>
 
 using Price = uint64_t;
 using Qty = uint64_t;
-using BidsMap = std::map<Price, Qty, std::greater<>>;
-using AsksMap = std::map<Price, Qty, std::less<>>;
+using LevelAllocator = PoolAllocator<std::pair<const Price, Qty>>;
+using BidsMap = std::map<Price, Qty, std::greater<>, LevelAllocator>;
+using AsksMap = std::map<Price, Qty, std::less<>, LevelAllocator>;
 
 struct SymbolScales {
     uint64_t priceScale = 1;
     uint64_t qtyScale = 1;
+    // Exchange tick size expressed in priceScale units.
+    uint64_t priceTick = 1;
+
+    bool operator==(const SymbolScales&) const = default;
 };
 
 struct Level {
@@ -23,6 +32,12 @@ struct OrderBookDelta {
     uint64_t lastUpdate = 0;
     std::vector<Level> bids;
     std::vector<Level> asks;
+    // Exchange timestamps in epoch milliseconds (`E` event, `T` transaction);
+    // 0 when the payload has none.
+    uint64_t eventTimeMs = 0;
+    uint64_t transactionTimeMs = 0;
+    // Local steady-clock time the carrying frame was read; epoch if unknown.
+    std::chrono::steady_clock::time_point receivedAt{};
 };
 
 struct OrderBookSnapshot {
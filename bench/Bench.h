@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchCase {
+    std::string name;
+    // Operations performed by one call of `body`; results are per operation.
+    std::size_t opsPerCall = 1;
+    std::function<void()> body;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0.0;
+};
+
+BenchResult runBenchCase(const BenchCase& benchCase, std::chrono::milliseconds minDuration);
+
+template <typename T> inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<const volatile T*>(&value));
+#endif
+}
+
+void addBookBenches(std::vector<BenchCase>& cases);
+void addDecimalBenches(std::vector<BenchCase>& cases);
+void addParserBenches(std::vector<BenchCase>& cases);
+void addShardBenches(std::vector<BenchCase>& cases);
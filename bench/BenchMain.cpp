@@ -0,0 +1,85 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+BenchResult runBenchCase(const BenchCase& benchCase, std::chrono::milliseconds minDuration) {
+    using clock = std::chrono::steady_clock;
+
+    // Warm caches and branch predictors before timing.
+    benchCase.body();
+
+    uint64_t calls = 0;
+    const auto start = clock::now();
+    auto now = start;
+    while (now - start < minDuration) {
+        benchCase.body();
+        ++calls;
+        now = clock::now();
+    }
+
+    const auto elapsedNs = std::chrono::duration<double, std::nano>(now - start).count();
+    const uint64_t ops = calls * benchCase.opsPerCall;
+    return BenchResult{
+        .name = benchCase.name,
+        .ops = ops,
+        .nsPerOp = ops == 0 ? 0.0 : elapsedNs / static_cast<double>(ops),
+    };
+}
+
+namespace {
+// Case names are plain ASCII without quotes or backslashes, so they go out
+// unescaped.
+void printJson(const std::vector<BenchResult>& results) {
+    std::printf("{\"benchmarks\":[");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        std::printf("%s\n  {\"name\":\"%s\",\"ops\":%llu,\"nsPerOp\":%.3f}", i == 0 ? "" : ",",
+                    results[i].name.c_str(), static_cast<unsigned long long>(results[i].ops),
+                    results[i].nsPerOp);
+    }
+    std::printf("\n]}\n");
+}
+} // namespace
+
+// orderbook_bench [--json] [--min-ms N] [FILTER]
+int main(int argc, char** argv) {
+    std::string_view filter;
+    bool json = false;
+    std::chrono::milliseconds minDuration(300);
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--min-ms" && i + 1 < argc) {
+            minDuration = std::chrono::milliseconds(std::strtoll(argv[++i], nullptr, 10));
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::vector<BenchCase> cases;
+    addBookBenches(cases);
+    addParserBenches(cases);
+    addDecimalBenches(cases);
+    addShardBenches(cases);
+
+    std::vector<BenchResult> results;
+    for (const auto& benchCase : cases) {
+        if (!filter.empty() && benchCase.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        const auto result = runBenchCase(benchCase, minDuration);
+        if (!json) {
+            std::printf("%-48s %12.2f ns/op %14llu ops\n", result.name.c_str(), result.nsPerOp,
+                        static_cast<unsigned long long>(result.ops));
+        }
+        results.push_back(result);
+    }
+    if (json) {
+        printJson(results);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+#include "Bench.h"
+
+#include "OrderBook.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr Price kTick = 10;
+constexpr Price kMid = 6'000'000;
+constexpr std::size_t kDeltas = 1024;
+constexpr std::size_t kLevelsPerDelta = 10;
+constexpr std::size_t kBookSizes[] = {100, 1000, 10000};
+// Levels shown by the GUI and the terminal view.
+constexpr std::size_t kTopLevels[] = {20, 25};
+
+// Where delta levels land, in ticks from the touch.
+enum class Spread {
+    // Most updates within a few ticks of the touch, as on a liquid book.
+    Touch,
+    // Evenly across the whole depth.
+    Uniform,
+};
+
+const char* spreadName(Spread spread) {
+    return spread == Spread::Touch ? "touch" : "uniform";
+}
+
+uint64_t pickOffset(std::mt19937_64& rng, Spread spread, std::size_t depth) {
+    if (spread == Spread::Uniform) {
+        return rng() % depth;
+    }
+    std::geometric_distribution<uint64_t> nearTouch(0.25);
+    return std::min<uint64_t>(nearTouch(rng), depth - 1);
+}
+
+OrderBookSnapshot makeSnapshot(std::size_t depth, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    OrderBookSnapshot snapshot;
+    snapshot.lastUpdate = 1000;
+    snapshot.bids.reserve(depth);
+    snapshot.asks.reserve(depth);
+    for (std::size_t i = 0; i < depth; ++i) {
+        snapshot.bids.push_back({.price = kMid - kTick * (i + 1), .qty = 1 + rng() % 100000});
+        snapshot.asks.push_back({.price = kMid + kTick * i, .qty = 1 + rng() % 100000});
+    }
+    return snapshot;
+}
+
+// Contiguous deltas against makeSnapshot(depth); a fifth of the levels are
+// removals, so the book settles near its starting size.
+std::vector<OrderBookDelta> makeDeltas(std::size_t depth, Spread spread, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<OrderBookDelta> deltas(kDeltas);
+    uint64_t lastUpdate = 1000;
+    for (auto& delta : deltas) {
+        delta.firstUpdate = lastUpdate + 1;
+        delta.lastUpdate = delta.firstUpdate + rng() % 5;
+        lastUpdate = delta.lastUpdate;
+        for (std::size_t i = 0; i < kLevelsPerDelta; ++i) {
+            const Qty qty = rng() % 5 == 0 ? 0 : 1 + rng() % 100000;
+            const uint64_t offset = pickOffset(rng, spread, depth);
+            if (i % 2 == 0) {
+                delta.bids.push_back({.price = kMid - kTick * (offset + 1), .qty = qty});
+            } else {
+                delta.asks.push_back({.price = kMid + kTick * offset, .qty = qty});
+            }
+        }
+    }
+    return deltas;
+}
+
+template <typename Book>
+void addBackendBenches(std::vector<BenchCase>& cases, const std::string& backend) {
+    for (const std::size_t depth : kBookSizes) {
+        const auto snapshot = std::make_shared<OrderBookSnapshot>(makeSnapshot(depth, depth));
+
+        for (const Spread spread : {Spread::Touch, Spread::Uniform}) {
+            auto book = std::make_shared<Book>(kTick);
+            book->applySnapshot(*snapshot);
+            const auto deltas =
+                std::make_shared<std::vector<OrderBookDelta>>(makeDeltas(depth, spread, depth + 1));
+            cases.push_back(BenchCase{
+                .name = "book/" + backend + "/delta/" + std::to_string(depth) + "/" +
+                        spreadName(spread),
+                .opsPerCall = kDeltas,
+                .body =
+                    [book, deltas]() {
+                        for (const auto& delta : *deltas) {
+                            book->applyDelta(delta);
+                        }
+                        doNotOptimize(book->getLastUpdate());
+                    },
+            });
+        }
+
+        auto book = std::make_shared<Book>(kTick);
+        cases.push_back(BenchCase{
+            .name = "book/" + backend + "/snapshot/" + std::to_string(depth),
+            .body =
+                [book, snapshot]() {
+                    book->applySnapshot(*snapshot);
+                    doNotOptimize(book->getLastUpdate());
+                },
+        });
+    }
+
+    // Top-of-book extraction as the renderers do it, on a 1000-level book.
+    const auto book = std::make_shared<Book>(kTick);
+    book->applySnapshot(makeSnapshot(1000, 1));
+    for (const std::size_t levels : kTopLevels) {
+        auto top = std::make_shared<std::vector<Level>>();
+        cases.push_back(BenchCase{
+            .name = "book/" + backend + "/top/" + std::to_string(levels),
+            .body =
+                [book, top, levels]() {
+                    book->topBids(levels, *top);
+                    doNotOptimize(top->back());
+                    book->topAsks(levels, *top);
+                    doNotOptimize(top->back());
+                },
+        });
+    }
+}
+} // namespace
+
+void addBookBenches(std::vector<BenchCase>& cases) {
+    addBackendBenches<LadderOrderBook>(cases, "ladder");
+    addBackendBenches<MapOrderBook>(cases, "map");
+}
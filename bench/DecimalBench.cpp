@@ -0,0 +1,90 @@
+#include "Bench.h"
+
+#include "ScaledDecimal.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+constexpr std::size_t kLevels = 1000;
+constexpr uint64_t kPriceScale = 100000000ULL;
+constexpr uint32_t kPricePlaces = 8;
+constexpr uint64_t kQtyScale = 1000ULL;
+constexpr uint32_t kQtyPlaces = 3;
+
+// Numeric strings shaped like a BTCUSDT 1000-level snapshot.
+struct DecimalInput {
+    std::vector<std::string> storage;
+    std::vector<std::string_view> prices;
+    std::vector<std::string_view> qtys;
+    std::vector<uint64_t> out;
+};
+
+std::shared_ptr<DecimalInput> makeInput() {
+    auto input = std::make_shared<DecimalInput>();
+    std::mt19937_64 rng(1);
+    input->storage.reserve(kLevels * 2);
+    for (std::size_t i = 0; i < kLevels; ++i) {
+        const uint64_t priceTicks = 600000 + (rng() % 20000);
+        input->storage.push_back(std::to_string(priceTicks / 10) + "." +
+                                 std::to_string(priceTicks % 10) + "0");
+        const uint64_t qty = rng() % 50000;
+        input->storage.push_back(std::to_string(qty / 1000) + "." +
+                                 std::to_string(1000 + qty % 1000).substr(1));
+    }
+    for (std::size_t i = 0; i < kLevels; ++i) {
+        input->prices.push_back(input->storage[2 * i]);
+        input->qtys.push_back(input->storage[2 * i + 1]);
+    }
+    input->out.resize(kLevels);
+    return input;
+}
+
+void addKernelCase(std::vector<BenchCase>& cases, const std::shared_ptr<DecimalInput>& input,
+                   ScaledDecimal::Kernel kernel) {
+    cases.push_back(BenchCase{
+        .name = std::string("decimal/batch/") + ScaledDecimal::kernelName(kernel),
+        .opsPerCall = kLevels * 2,
+        .body =
+            [input, kernel]() {
+                const bool ok = ScaledDecimal::parseBatch(kernel, input->prices.data(),
+                                                          input->out.data(), kLevels, kPriceScale,
+                                                          kPricePlaces) &&
+                                ScaledDecimal::parseBatch(kernel, input->qtys.data(),
+                                                          input->out.data(), kLevels, kQtyScale,
+                                                          kQtyPlaces);
+                doNotOptimize(ok);
+                doNotOptimize(input->out.front());
+            },
+    });
+}
+} // namespace
+
+void addDecimalBenches(std::vector<BenchCase>& cases) {
+    const auto input = makeInput();
+
+    // The per-value routine the parsers used before the batch kernels.
+    cases.push_back(BenchCase{
+        .name = "decimal/parse/scalar",
+        .opsPerCall = kLevels * 2,
+        .body =
+            [input]() {
+                for (std::size_t i = 0; i < kLevels; ++i) {
+                    doNotOptimize(ScaledDecimal::parse(input->prices[i], kPriceScale, kPricePlaces));
+                    doNotOptimize(ScaledDecimal::parse(input->qtys[i], kQtyScale, kQtyPlaces));
+                }
+            },
+    });
+
+    addKernelCase(cases, input, ScaledDecimal::Kernel::Scalar);
+    const auto best = ScaledDecimal::bestKernel();
+    if (best != ScaledDecimal::Kernel::Scalar) {
+        addKernelCase(cases, input, ScaledDecimal::Kernel::Sse41);
+    }
+    if (best == ScaledDecimal::Kernel::Avx2) {
+        addKernelCase(cases, input, ScaledDecimal::Kernel::Avx2);
+    }
+}
@@ -0,0 +1,238 @@
+#include "MockExchange.h"
+
+#include "BinanceScalesSource.h"
+#include "BinanceSnapshotSource.h"
+#include "HttpsClient.h"
+#include "MultiSymbolEngine.h"
+#include "ShardedRuntime.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Wire-to-book latency through the real network path: the mock exchange
+// stamps each event as it queues it, and the engine looks the stamp up when
+// the book has applied that event. Both run in this process over loopback
+// TLS, so the figure covers framing, TLS, WebSocket, routing, parsing,
+// sequencing and the book update. Samples are taken only while the book is
+// live, after `--warmup`.
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    MockExchange::Options exchange;
+    std::size_t shards = 1;
+    bool pinThreads = false;
+    std::chrono::seconds warmup{2};
+    std::chrono::seconds duration{10};
+};
+
+struct SymbolLatency {
+    std::mutex mutex;
+    // Keyed by the event's last update id; filled by the exchange thread.
+    std::map<uint64_t, Clock::time_point> sent;
+    // Owned by the symbol's sync strand.
+    std::vector<uint64_t> samplesNs;
+    uint64_t resyncs = 0;
+    // Event time to local read, as the sync measures it on the exchange
+    // clock estimate.
+    LatencyHistogram::Percentiles feed;
+};
+
+BenchOptions parseArgs(int argc, char** argv) {
+    BenchOptions options;
+    options.exchange.symbols.clear();
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (MockExchange::parseFlag(options.exchange, i, argc, argv)) {
+            continue;
+        }
+        if (arg == "--shards" && i + 1 < argc) {
+            options.shards = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--pin") {
+            options.pinThreads = true;
+            continue;
+        }
+        if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::chrono::seconds(std::strtoll(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--seconds" && i + 1 < argc) {
+            options.duration = std::chrono::seconds(std::strtoll(argv[++i], nullptr, 10));
+            continue;
+        }
+        std::string symbol(arg);
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        options.exchange.symbols.push_back(std::move(symbol));
+    }
+    if (options.exchange.symbols.empty()) {
+        options.exchange.symbols = {"BTCUSDT", "ETHUSDT", "BNBUSDT", "SOLUSDT"};
+    }
+    return options;
+}
+
+double percentileUs(const std::vector<uint64_t>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(percentile / 100.0 *
+                                               static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[rank]) / 1000.0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const BenchOptions options = parseArgs(argc, argv);
+    const auto& symbols = options.exchange.symbols;
+
+    std::map<std::string, std::unique_ptr<SymbolLatency>, std::less<>> latencies;
+    for (const auto& symbol : symbols) {
+        latencies.emplace(symbol, std::make_unique<SymbolLatency>());
+    }
+
+    MockExchange exchange(options.exchange);
+    exchange.setOnSent([&latencies](std::string_view symbol, uint64_t lastUpdate,
+                                    Clock::time_point sentAt) {
+        auto& latency = *latencies.find(symbol)->second;
+        std::lock_guard<std::mutex> lock(latency.mutex);
+        latency.sent.emplace(lastUpdate, sentAt);
+    });
+    if (!exchange.start()) {
+        return EXIT_FAILURE;
+    }
+    const auto caFile = (std::filesystem::temp_directory_path() /
+                         ("orderbook_mock_ca_" + std::to_string(exchange.port()) + ".pem"))
+                            .string();
+    if (!exchange.writeCaFile(caFile)) {
+        return EXIT_FAILURE;
+    }
+    const BinanceHosts hosts = exchange.hosts(caFile);
+
+    ShardedRuntime runtime(ShardedRuntime::Options{
+        .shards = options.shards,
+        .pinThreads = options.pinThreads,
+    });
+    runtime.start();
+
+    BinanceScalesSource scalesSource(
+        HttpsClient::create(runtime.shard(0), BinanceSnapshotSource::restOptions(hosts)),
+        ScalesCache());
+    std::promise<std::optional<BinanceScalesSource::ScalesBySymbol>> scalesPromise;
+    auto scalesFuture = scalesPromise.get_future();
+    scalesSource.fetchAsync(symbols, [&scalesPromise](auto scales) {
+        scalesPromise.set_value(std::move(scales));
+    });
+    const auto scales = scalesFuture.get();
+    if (!scales) {
+        std::cerr << "exchangeInfo from the mock exchange failed\n";
+        runtime.stop();
+        runtime.join();
+        return EXIT_FAILURE;
+    }
+
+    std::vector<MultiSymbolEngine::SymbolConfig> configs;
+    for (const auto& symbol : symbols) {
+        configs.push_back({.symbol = symbol, .scales = scales->at(symbol)});
+    }
+    MultiSymbolEngine engine(runtime, std::move(configs), {}, 100, 1, {}, {}, {}, hosts);
+
+    std::atomic<bool> measuring{false};
+    for (std::size_t i = 0; i < engine.size(); ++i) {
+        auto& latency = *latencies.at(engine.symbol(i));
+        engine.sync(i).setOnBookUpdated(
+            [&latency, &measuring](const OrderBook& book, const SymbolScales&,
+                                   const BinanceOrderBookSync::SyncStats& stats) {
+                const auto now = Clock::now();
+                Clock::time_point sentAt;
+                {
+                    std::lock_guard<std::mutex> lock(latency.mutex);
+                    const auto it = latency.sent.find(book.getLastUpdate());
+                    if (it == latency.sent.end()) {
+                        return;
+                    }
+                    sentAt = it->second;
+                    latency.sent.erase(latency.sent.begin(), std::next(it));
+                }
+                latency.resyncs = stats.resyncs;
+                latency.feed = stats.latency.feed;
+                if (measuring.load(std::memory_order_relaxed) && stats.firstSyncMs != 0 &&
+                    !stats.stale) {
+                    latency.samplesNs.push_back(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now - sentAt)
+                            .count()));
+                }
+            });
+    }
+    engine.start();
+
+    std::this_thread::sleep_for(options.warmup);
+    measuring = true;
+    std::this_thread::sleep_for(options.duration);
+    measuring = false;
+    const auto clock = engine.clockEstimate();
+
+    engine.stop();
+    runtime.stop();
+    runtime.join();
+    exchange.stop();
+    std::filesystem::remove(caFile);
+
+    std::vector<uint64_t> samples;
+    uint64_t resyncs = 0;
+    for (const auto& [symbol, latency] : latencies) {
+        samples.insert(samples.end(), latency->samplesNs.begin(), latency->samplesNs.end());
+        resyncs += latency->resyncs;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const auto stats = exchange.stats();
+    std::printf("%zu symbols x %.0f events/s, %zu shards, %lld s measured\n", symbols.size(),
+                options.exchange.messagesPerSecond, runtime.shardCount(),
+                static_cast<long long>(options.duration.count()));
+    std::printf("sent %llu events (%llu gaps, %llu stalls, %llu disconnects), %llu snapshots, "
+                "%llu resyncs\n",
+                static_cast<unsigned long long>(stats.messages),
+                static_cast<unsigned long long>(stats.gaps),
+                static_cast<unsigned long long>(stats.stalls),
+                static_cast<unsigned long long>(stats.disconnects),
+                static_cast<unsigned long long>(stats.snapshots),
+                static_cast<unsigned long long>(resyncs));
+    std::printf("wire-to-book over %zu samples: p50 %.1f us, p90 %.1f us, p99 %.1f us, "
+                "p99.9 %.1f us, max %.1f us\n",
+                samples.size(), percentileUs(samples, 50.0), percentileUs(samples, 90.0),
+                percentileUs(samples, 99.0), percentileUs(samples, 99.9),
+                percentileUs(samples, 100.0));
+    // The mock stamps events in whole milliseconds, so feed lag is good to
+    // about half a millisecond; the offset should land within half a round
+    // trip of the configured skew.
+    if (clock) {
+        std::printf("exchange clock offset %.3f ms (+/- %.3f ms over %llu rounds, skew %lld ms)\n",
+                    static_cast<double>(clock->offsetUs) / 1000.0,
+                    static_cast<double>(clock->roundTripUs) / 2000.0,
+                    static_cast<unsigned long long>(clock->rounds),
+                    static_cast<long long>(options.exchange.clockSkew.count()));
+    }
+    for (const auto& [symbol, latency] : latencies) {
+        std::printf("%s feed lag: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", symbol.c_str(),
+                    static_cast<double>(latency->feed.p50Ns) / 1e6,
+                    static_cast<double>(latency->feed.p99Ns) / 1e6,
+                    static_cast<double>(latency->feed.maxNs) / 1e6);
+    }
+    return samples.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,803 @@
+#include "MockExchange.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl/stream_base.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace ssl = asio::ssl;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+
+namespace {
+constexpr auto kTickInterval = std::chrono::milliseconds(1);
+// Events per symbol one tick may emit to catch up after a slow tick.
+constexpr uint64_t kMaxBurst = 1000;
+// Frames a stream connection may have queued before it is dropped, as
+// Binance does with consumers that cannot keep up.
+constexpr std::size_t kMaxQueuedFrames = 65536;
+constexpr std::size_t kDefaultSnapshotLimit = 1000;
+// Ticks of 0.01 and steps of 0.001, as exchangeInfo reports below.
+constexpr uint64_t kMid = 5'000'000;
+constexpr uint32_t kPricePlaces = 2;
+constexpr uint32_t kQtyPlaces = 3;
+constexpr uint64_t kMaxQty = 5000;
+constexpr uint64_t kHotLevels = 64;
+
+using X509Ptr = std::unique_ptr<X509, decltype(&X509_free)>;
+using KeyPtr = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+
+struct Credentials {
+    std::string caCert;
+    std::string cert;
+    std::string key;
+};
+
+bool addExtension(X509* cert, X509* issuer, int nid, const char* value) {
+    X509V3_CTX context;
+    X509V3_set_ctx_nodb(&context);
+    X509V3_set_ctx(&context, issuer, cert, nullptr, nullptr, 0);
+    X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &context, nid, value);
+    if (!extension) {
+        return false;
+    }
+    const bool added = X509_add_ext(cert, extension, -1) == 1;
+    X509_EXTENSION_free(extension);
+    return added;
+}
+
+// Self-signed when `issuer` is null.
+X509Ptr makeCertificate(EVP_PKEY* key, const char* commonName, long serial, X509* issuer,
+                        EVP_PKEY* issuerKey,
+                        const std::vector<std::pair<int, const char*>>& extensions) {
+    X509Ptr cert(X509_new(), X509_free);
+    if (!cert) {
+        return cert;
+    }
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), serial);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 30L * 24 * 3600);
+    X509_set_pubkey(cert.get(), key);
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(commonName), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), issuer ? X509_get_subject_name(issuer) : name);
+
+    X509* signer = issuer ? issuer : cert.get();
+    for (const auto& [nid, value] : extensions) {
+        if (!addExtension(cert.get(), signer, nid, value)) {
+            return X509Ptr(nullptr, X509_free);
+        }
+    }
+    if (X509_sign(cert.get(), issuerKey ? issuerKey : key, EVP_sha256()) == 0) {
+        return X509Ptr(nullptr, X509_free);
+    }
+    return cert;
+}
+
+template <typename Write> std::string toPem(Write write) {
+    std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), BIO_free);
+    if (!bio || write(bio.get()) != 1) {
+        return {};
+    }
+    char* data = nullptr;
+    const long size = BIO_get_mem_data(bio.get(), &data);
+    return std::string(data, static_cast<std::size_t>(size));
+}
+
+// A fresh P-256 CA and a `localhost` / 127.0.0.1 server certificate it signed.
+std::optional<Credentials> issueCredentials() {
+    KeyPtr caKey(EVP_EC_gen("P-256"), EVP_PKEY_free);
+    KeyPtr key(EVP_EC_gen("P-256"), EVP_PKEY_free);
+    if (!caKey || !key) {
+        return std::nullopt;
+    }
+    const auto ca = makeCertificate(caKey.get(), "orderbook mock CA", 1, nullptr, nullptr,
+                                    {
+                                        {NID_basic_constraints, "critical,CA:TRUE"},
+                                        {NID_key_usage, "critical,keyCertSign,cRLSign"},
+                                        {NID_subject_key_identifier, "hash"},
+                                    });
+    if (!ca) {
+        return std::nullopt;
+    }
+    const auto cert = makeCertificate(key.get(), "localhost", 2, ca.get(), caKey.get(),
+                                      {
+                                          {NID_basic_constraints, "critical,CA:FALSE"},
+                                          {NID_key_usage, "critical,digitalSignature"},
+                                          {NID_ext_key_usage, "serverAuth"},
+                                          {NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1"},
+                                          {NID_authority_key_identifier, "keyid"},
+                                      });
+    if (!cert) {
+        return std::nullopt;
+    }
+
+    Credentials credentials{
+        .caCert = toPem([&ca](BIO* bio) { return PEM_write_bio_X509(bio, ca.get()); }),
+        .cert = toPem([&cert](BIO* bio) { return PEM_write_bio_X509(bio, cert.get()); }),
+        .key = toPem([&key](BIO* bio) {
+            return PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr,
+                                            nullptr);
+        }),
+    };
+    if (credentials.caCert.empty() || credentials.cert.empty() || credentials.key.empty()) {
+        return std::nullopt;
+    }
+    return credentials;
+}
+
+void appendUint(std::string& out, uint64_t value) {
+    char digits[20];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// `value` in units of 10^-places, as a quoted decimal string.
+void appendDecimal(std::string& out, uint64_t value, uint32_t places) {
+    uint64_t unit = 1;
+    for (uint32_t i = 0; i < places; ++i) {
+        unit *= 10;
+    }
+    out += '"';
+    appendUint(out, value / unit);
+    out += '.';
+    char fraction[20];
+    const auto result = std::to_chars(fraction, fraction + sizeof(fraction), value % unit);
+    out.append(places - static_cast<std::size_t>(result.ptr - fraction), '0');
+    out.append(fraction, result.ptr);
+    out += '"';
+}
+
+template <typename Levels>
+void appendLevels(std::string& out, const Levels& levels, std::size_t limit) {
+    out += '[';
+    std::size_t count = 0;
+    for (const auto& [price, qty] : levels) {
+        if (count == limit) {
+            break;
+        }
+        if (count++ != 0) {
+            out += ',';
+        }
+        out += '[';
+        appendDecimal(out, price, kPricePlaces);
+        out += ',';
+        appendDecimal(out, qty, kQtyPlaces);
+        out += ']';
+    }
+    out += ']';
+}
+
+uint64_t epochMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+std::string upper(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return result;
+}
+
+std::string_view queryParam(std::string_view query, std::string_view key) {
+    while (!query.empty()) {
+        const auto end = query.find('&');
+        const auto pair = query.substr(0, end);
+        const auto equals = pair.find('=');
+        if (equals != std::string_view::npos && pair.substr(0, equals) == key) {
+            return pair.substr(equals + 1);
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(end + 1);
+    }
+    return {};
+}
+} // namespace
+
+// One subscribed WebSocket connection; frames are queued and written one at
+// a time. Everything runs on the server thread.
+class MockExchange::StreamSession : public std::enable_shared_from_this<StreamSession> {
+  public:
+    StreamSession(MockExchange& exchange, beast::ssl_stream<beast::tcp_stream>&& stream)
+        : exchange_(exchange), ws_(std::move(stream)) {
+    }
+
+    void run(http::request<http::string_body> request) {
+        const std::string_view target(request.target().data(), request.target().size());
+        std::string_view names;
+        if (target.starts_with("/ws/")) {
+            names = target.substr(4);
+        } else if (target.starts_with("/stream?")) {
+            names = queryParam(target.substr(8), "streams");
+            combined_ = true;
+        }
+        while (!names.empty()) {
+            const auto end = names.find('/');
+            const auto name = names.substr(0, end);
+            if (const auto index = exchange_.marketIndex(upper(name.substr(0, name.find('@'))))) {
+                streams_.push_back({.market = *index, .name = std::string(name)});
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            names.remove_prefix(end + 1);
+        }
+        if (streams_.empty()) {
+            return;
+        }
+
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws_.async_accept(request, [self = shared_from_this()](beast::error_code ec) {
+            if (ec) {
+                return;
+            }
+            self->exchange_.subscribe(self);
+            self->read();
+        });
+    }
+
+    bool open() const {
+        return !closed_;
+    }
+
+    void send(std::size_t market, std::string_view event) {
+        const auto stream = std::find_if(streams_.begin(), streams_.end(),
+                                         [market](const auto& s) { return s.market == market; });
+        if (closed_ || stream == streams_.end()) {
+            return;
+        }
+        if (queue_.size() >= kMaxQueuedFrames) {
+            exchange_.updateStats([](Stats& stats) { ++stats.slowConsumers; });
+            drop();
+            return;
+        }
+        if (combined_) {
+            std::string frame;
+            frame.reserve(event.size() + stream->name.size() + 20);
+            frame += R"({"stream":")";
+            frame += stream->name;
+            frame += R"(","data":)";
+            frame += event;
+            frame += '}';
+            queue_.push_back(std::move(frame));
+        } else {
+            queue_.emplace_back(event);
+        }
+        if (!writing_) {
+            write();
+        }
+    }
+
+    // Closes the TCP connection without a close frame.
+    void drop() {
+        closed_ = true;
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws_).socket().close(ignored);
+    }
+
+  private:
+    struct Stream {
+        std::size_t market = 0;
+        std::string name;
+    };
+
+    void write() {
+        writing_ = true;
+        ws_.text(true);
+        ws_.async_write(asio::buffer(queue_.front()),
+                        [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                            self->queue_.pop_front();
+                            if (ec) {
+                                self->closed_ = true;
+                                self->queue_.clear();
+                            }
+                            if (self->queue_.empty()) {
+                                self->writing_ = false;
+                                return;
+                            }
+                            self->write();
+                        });
+    }
+
+    // Keeps a read pending so pings are answered and closes are noticed.
+    void read() {
+        ws_.async_read(readBuffer_, [self = shared_from_this()](beast::error_code ec,
+                                                                std::size_t bytes) {
+            if (ec) {
+                self->closed_ = true;
+                return;
+            }
+            self->readBuffer_.consume(bytes);
+            self->read();
+        });
+    }
+
+    MockExchange& exchange_;
+    websocket::stream<beast::ssl_stream<beast::tcp_stream>> ws_;
+    beast::flat_buffer readBuffer_;
+    std::vector<Stream> streams_;
+    bool combined_ = false;
+    std::deque<std::string> queue_;
+    bool writing_ = false;
+    bool closed_ = false;
+};
+
+// A keep-alive REST connection, or the handshake of a stream connection
+// that is handed to a StreamSession once it asks for the upgrade.
+class MockExchange::HttpSession : public std::enable_shared_from_this<HttpSession> {
+  public:
+    HttpSession(MockExchange& exchange, tcp::socket socket)
+        : exchange_(exchange), stream_(std::move(socket), exchange.tls_), delay_(exchange.io_) {
+    }
+
+    void run() {
+        stream_.async_handshake(ssl::stream_base::server,
+                                [self = shared_from_this()](beast::error_code ec) {
+                                    if (!ec) {
+                                        self->read();
+                                    }
+                                });
+    }
+
+  private:
+    using Response = http::response<http::string_body>;
+
+    void read() {
+        request_ = {};
+        http::async_read(stream_, buffer_, request_,
+                         [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                             if (!ec) {
+                                 self->onRequest();
+                             }
+                         });
+    }
+
+    void onRequest() {
+        if (websocket::is_upgrade(request_)) {
+            std::make_shared<StreamSession>(exchange_, std::move(stream_))
+                ->run(std::move(request_));
+            return;
+        }
+
+        const std::string_view target(request_.target().data(), request_.target().size());
+        const auto question = target.find('?');
+        const auto path = target.substr(0, question);
+        const auto query =
+            question == std::string_view::npos ? std::string_view{} : target.substr(question + 1);
+
+        auto response = std::make_shared<Response>(http::status::ok, request_.version());
+        response->set(http::field::content_type, "application/json");
+        response->keep_alive(request_.keep_alive());
+        std::chrono::milliseconds delay{0};
+        if (path == "/fapi/v1/ping") {
+            response->body() = "{}";
+        } else if (path == "/fapi/v1/time") {
+            response->body() = R"({"serverTime":)" + std::to_string(exchange_.serverTimeMs()) + "}";
+            exchange_.updateStats([](Stats& stats) { ++stats.serverTimes; });
+        } else if (path == "/fapi/v1/exchangeInfo") {
+            response->body() = exchange_.exchangeInfoBody();
+            exchange_.updateStats([](Stats& stats) { ++stats.exchangeInfos; });
+        } else if (path == "/fapi/v1/depth") {
+            const auto index = exchange_.marketIndex(queryParam(query, "symbol"));
+            const auto limitText = queryParam(query, "limit");
+            std::size_t limit = kDefaultSnapshotLimit;
+            std::from_chars(limitText.data(), limitText.data() + limitText.size(), limit);
+            if (index) {
+                response->body() = exchange_.snapshotBody(*index, limit);
+                delay = exchange_.options_.faults.snapshotDelay;
+                exchange_.updateStats([](Stats& stats) { ++stats.snapshots; });
+            } else {
+                response->result(http::status::bad_request);
+                response->body() = R"({"code":-1121,"msg":"Invalid symbol."})";
+            }
+        } else {
+            response->result(http::status::not_found);
+            response->body() = R"({"code":-1000,"msg":"Unknown endpoint."})";
+        }
+        response->prepare_payload();
+
+        if (delay.count() <= 0) {
+            write(std::move(response));
+            return;
+        }
+        delay_.expires_after(delay);
+        delay_.async_wait([self = shared_from_this(), response](beast::error_code) mutable {
+            self->write(std::move(response));
+        });
+    }
+
+    void write(std::shared_ptr<Response> response) {
+        http::async_write(stream_, *response,
+                          [self = shared_from_this(), response](beast::error_code ec, std::size_t) {
+                              if (ec) {
+                                  return;
+                              }
+                              if (!response->keep_alive()) {
+                                  beast::error_code ignored;
+                                  beast::get_lowest_layer(self->stream_).socket().shutdown(
+                                      tcp::socket::shutdown_send, ignored);
+                                  return;
+                              }
+                              self->read();
+                          });
+    }
+
+    MockExchange& exchange_;
+    beast::ssl_stream<beast::tcp_stream> stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    asio::steady_timer delay_;
+};
+
+bool MockExchange::parseFlag(Options& options, int& i, int argc, char** argv) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    const std::string_view arg = argv[i];
+    const char* value = argv[i + 1];
+    if (arg == "--rate") {
+        options.messagesPerSecond = std::strtod(value, nullptr);
+    } else if (arg == "--levels") {
+        options.levelsPerUpdate = static_cast<std::size_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--depth") {
+        options.bookDepth = static_cast<std::size_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--clock-skew-ms") {
+        options.clockSkew = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--gap") {
+        options.faults.gapProbability = std::strtod(value, nullptr);
+    } else if (arg == "--stall") {
+        options.faults.stallProbability = std::strtod(value, nullptr);
+    } else if (arg == "--stall-ms") {
+        options.faults.stallDuration = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--disconnect") {
+        options.faults.disconnectProbability = std::strtod(value, nullptr);
+    } else if (arg == "--snapshot-delay-ms") {
+        options.faults.snapshotDelay = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+    } else if (arg == "--seed") {
+        options.faults.seed = std::strtoull(value, nullptr, 10);
+    } else {
+        return false;
+    }
+    ++i;
+    return true;
+}
+
+MockExchange::MockExchange(Options options)
+    : options_(std::move(options)),
+      tls_(ssl::context::tls_server),
+      acceptor_(io_),
+      timer_(io_),
+      random_(options_.faults.seed) {
+    for (const auto& symbol : options_.symbols) {
+        Market market;
+        market.symbol = upper(symbol);
+        for (uint64_t offset = 1; offset <= options_.bookDepth; ++offset) {
+            market.bids[kMid - offset] = 1 + random_() % kMaxQty;
+            market.asks[kMid + offset] = 1 + random_() % kMaxQty;
+        }
+        markets_.push_back(std::move(market));
+    }
+}
+
+MockExchange::~MockExchange() {
+    stop();
+}
+
+bool MockExchange::start() {
+    const auto credentials = issueCredentials();
+    if (!credentials) {
+        std::cerr << "MockExchange cannot issue certificates\n";
+        return false;
+    }
+    caPem_ = credentials->caCert;
+
+    beast::error_code ec;
+    const std::string chain = credentials->cert + credentials->caCert;
+    tls_.use_certificate_chain(asio::buffer(chain), ec);
+    if (!ec) {
+        tls_.use_private_key(asio::buffer(credentials->key), ssl::context::pem, ec);
+    }
+    if (ec) {
+        std::cerr << "MockExchange TLS setup failed: " << ec.message() << '\n';
+        return false;
+    }
+
+    const auto address = asio::ip::make_address(options_.address, ec);
+    if (!ec) {
+        const tcp::endpoint endpoint(address, options_.port);
+        acceptor_.open(endpoint.protocol(), ec);
+        if (!ec) {
+            acceptor_.set_option(asio::socket_base::reuse_address(true), ec);
+        }
+        if (!ec) {
+            acceptor_.bind(endpoint, ec);
+        }
+        if (!ec) {
+            acceptor_.listen(asio::socket_base::max_listen_connections, ec);
+        }
+    }
+    if (ec) {
+        std::cerr << "MockExchange cannot listen on " << options_.address << ':' << options_.port
+                  << ": " << ec.message() << '\n';
+        return false;
+    }
+    port_ = acceptor_.local_endpoint().port();
+
+    paceStart_ = std::chrono::steady_clock::now();
+    paced_ = 0;
+    accept();
+    scheduleTick();
+    thread_ = std::thread([this]() { io_.run(); });
+    return true;
+}
+
+void MockExchange::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    asio::post(io_, [this]() {
+        beast::error_code ignored;
+        acceptor_.close(ignored);
+        timer_.cancel();
+        for (const auto& subscriber : subscribers_) {
+            if (const auto session = subscriber.lock()) {
+                session->drop();
+            }
+        }
+        subscribers_.clear();
+        io_.stop();
+    });
+    thread_.join();
+}
+
+void MockExchange::setOnSent(OnSent onSent) {
+    onSent_ = std::move(onSent);
+}
+
+bool MockExchange::writeCaFile(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << caPem_;
+    if (!out) {
+        std::cerr << "MockExchange cannot write " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+BinanceHosts MockExchange::hosts(std::string caFile) const {
+    const std::string port = std::to_string(port_);
+    return BinanceHosts{
+        .rest = "localhost",
+        .restPort = port,
+        .stream = "localhost",
+        .streamPort = port,
+        .caFile = std::move(caFile),
+    };
+}
+
+MockExchange::Stats MockExchange::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void MockExchange::accept() {
+    acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if (ec == asio::error::operation_aborted) {
+            return;
+        }
+        if (!ec) {
+            beast::error_code ignored;
+            socket.set_option(tcp::no_delay(true), ignored);
+            updateStats([](Stats& stats) { ++stats.connections; });
+            std::make_shared<HttpSession>(*this, std::move(socket))->run();
+        }
+        accept();
+    });
+}
+
+void MockExchange::scheduleTick() {
+    timer_.expires_after(kTickInterval);
+    timer_.async_wait([this](beast::error_code ec) {
+        if (!ec) {
+            tick();
+        }
+    });
+}
+
+// Emits whatever the configured rate owes since `paceStart_`, so a late
+// tick catches up instead of lowering the rate.
+void MockExchange::tick() {
+    const auto now = std::chrono::steady_clock::now();
+    if (roll(options_.faults.stallProbability)) {
+        updateStats([](Stats& stats) { ++stats.stalls; });
+        paceStart_ = now + options_.faults.stallDuration;
+        paced_ = 0;
+        timer_.expires_at(paceStart_);
+        timer_.async_wait([this](beast::error_code ec) {
+            if (!ec) {
+                tick();
+            }
+        });
+        return;
+    }
+
+    if (now > paceStart_) {
+        const double elapsed = std::chrono::duration<double>(now - paceStart_).count();
+        const auto due = static_cast<uint64_t>(elapsed * options_.messagesPerSecond);
+        if (due > paced_ + kMaxBurst) {
+            paced_ = due - kMaxBurst;
+        }
+        const uint64_t eventMs = serverTimeMs();
+        for (; paced_ < due; ++paced_) {
+            for (std::size_t index = 0; index < markets_.size(); ++index) {
+                emit(index, eventMs);
+            }
+        }
+    }
+    scheduleTick();
+}
+
+void MockExchange::emit(std::size_t index, uint64_t eventMs) {
+    Market& market = markets_[index];
+    const uint64_t previous = market.lastUpdate;
+    const uint64_t first = previous + 1;
+    market.lastUpdate = first + random_() % 3;
+
+    std::map<uint64_t, uint64_t, std::greater<>> bids;
+    std::map<uint64_t, uint64_t> asks;
+    const uint64_t hotLevels = std::clamp<uint64_t>(options_.bookDepth, 1, kHotLevels);
+    for (std::size_t i = 0; i < options_.levelsPerUpdate; ++i) {
+        const uint64_t offset = 1 + random_() % hotLevels;
+        const uint64_t qty = random_() % 5 == 0 ? 0 : 1 + random_() % kMaxQty;
+        if (i % 2 == 0) {
+            bids[kMid - offset] = qty;
+        } else {
+            asks[kMid + offset] = qty;
+        }
+    }
+    for (const auto& [price, qty] : bids) {
+        if (qty == 0) {
+            market.bids.erase(price);
+        } else {
+            market.bids[price] = qty;
+        }
+    }
+    for (const auto& [price, qty] : asks) {
+        if (qty == 0) {
+            market.asks.erase(price);
+        } else {
+            market.asks[price] = qty;
+        }
+    }
+
+    if (roll(options_.faults.gapProbability)) {
+        updateStats([](Stats& stats) { ++stats.gaps; });
+        return;
+    }
+
+    event_.clear();
+    event_ += R"({"e":"depthUpdate","E":)";
+    appendUint(event_, eventMs);
+    event_ += R"(,"T":)";
+    appendUint(event_, eventMs);
+    event_ += R"(,"s":")";
+    event_ += market.symbol;
+    event_ += R"(","U":)";
+    appendUint(event_, first);
+    event_ += R"(,"u":)";
+    appendUint(event_, market.lastUpdate);
+    event_ += R"(,"pu":)";
+    appendUint(event_, previous);
+    event_ += R"(,"b":)";
+    appendLevels(event_, bids, bids.size());
+    event_ += R"(,"a":)";
+    appendLevels(event_, asks, asks.size());
+    event_ += '}';
+
+    if (onSent_) {
+        onSent_(market.symbol, market.lastUpdate, std::chrono::steady_clock::now());
+    }
+    std::erase_if(subscribers_, [](const auto& subscriber) {
+        const auto session = subscriber.lock();
+        return !session || !session->open();
+    });
+    for (const auto& subscriber : subscribers_) {
+        subscriber.lock()->send(index, event_);
+    }
+    updateStats([](Stats& stats) { ++stats.messages; });
+
+    if (!subscribers_.empty() && roll(options_.faults.disconnectProbability)) {
+        subscribers_[random_() % subscribers_.size()].lock()->drop();
+        updateStats([](Stats& stats) { ++stats.disconnects; });
+    }
+}
+
+std::string MockExchange::snapshotBody(std::size_t index, std::size_t limit) const {
+    const Market& market = markets_[index];
+    const uint64_t now = serverTimeMs();
+    std::string body;
+    body.reserve(64 + 2 * std::min(limit, options_.bookDepth) * 24);
+    body += R"({"lastUpdateId":)";
+    appendUint(body, market.lastUpdate);
+    body += R"(,"E":)";
+    appendUint(body, now);
+    body += R"(,"T":)";
+    appendUint(body, now);
+    body += R"(,"bids":)";
+    appendLevels(body, market.bids, limit);
+    body += R"(,"asks":)";
+    appendLevels(body, market.asks, limit);
+    body += '}';
+    return body;
+}
+
+uint64_t MockExchange::serverTimeMs() const {
+    return epochMs() + static_cast<uint64_t>(options_.clockSkew.count());
+}
+
+std::string MockExchange::exchangeInfoBody() const {
+    std::string body = R"({"timezone":"UTC","serverTime":)";
+    appendUint(body, serverTimeMs());
+    body += R"(,"symbols":[)";
+    for (std::size_t i = 0; i < markets_.size(); ++i) {
+        if (i != 0) {
+            body += ',';
+        }
+        body += R"({"symbol":")";
+        body += markets_[i].symbol;
+        body += R"(","status":"TRADING","pricePrecision":2,"quantityPrecision":3,)"
+                R"("filters":[{"filterType":"PRICE_FILTER","minPrice":"0.01",)"
+                R"("maxPrice":"1000000","tickSize":"0.01"},{"filterType":"LOT_SIZE",)"
+                R"("minQty":"0.001","maxQty":"1000","stepSize":"0.001"}]})";
+    }
+    body += "]}";
+    return body;
+}
+
+std::optional<std::size_t> MockExchange::marketIndex(std::string_view symbol) const {
+    for (std::size_t i = 0; i < markets_.size(); ++i) {
+        if (markets_[i].symbol == symbol) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+void MockExchange::subscribe(const std::shared_ptr<StreamSession>& session) {
+    subscribers_.push_back(session);
+}
+
+bool MockExchange::roll(double probability) {
+    return probability > 0.0 &&
+           std::uniform_real_distribution<double>(0.0, 1.0)(random_) < probability;
+}
+
+template <typename Update> void MockExchange::updateStats(Update update) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    update(stats_);
+}
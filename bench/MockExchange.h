@@ -0,0 +1,152 @@
+#pragma once
+
+#include "BinanceHosts.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Local stand-in for the Binance futures endpoints the engine talks to:
+// `/ws/<stream>` and `/stream?streams=...` depth streams, `/fapi/v1/depth`,
+// `/fapi/v1/exchangeInfo`, `/fapi/v1/time` and `/fapi/v1/ping`, all over TLS
+// on one port.
+// The certificate is issued at start by a throwaway CA, which clients trust
+// through BinanceHosts::caFile. Every symbol churns a book around a fixed
+// mid price and emits depthUpdate events at a fixed rate, with optional
+// sequence gaps, stalls, dropped connections and slow snapshots.
+class MockExchange {
+  public:
+    struct Faults {
+        // Per event: applied to the book but never sent.
+        double gapProbability = 0.0;
+        // Per generator tick (1 ms): every stream goes silent for
+        // `stallDuration`.
+        double stallProbability = 0.0;
+        std::chrono::milliseconds stallDuration{2000};
+        // Per event: one stream connection is dropped without a close frame.
+        double disconnectProbability = 0.0;
+        std::chrono::milliseconds snapshotDelay{0};
+        uint64_t seed = 1;
+    };
+
+    struct Options {
+        std::string address = "127.0.0.1";
+        // 0 picks a free port; see port().
+        uint16_t port = 0;
+        std::vector<std::string> symbols = {"BTCUSDT"};
+        // Events per second per symbol.
+        double messagesPerSecond = 1000.0;
+        std::size_t levelsPerUpdate = 8;
+        std::size_t bookDepth = 2000;
+        // Added to every timestamp served, as a clock running ahead of
+        // (or, negative, behind) the local one.
+        std::chrono::milliseconds clockSkew{0};
+        Faults faults;
+    };
+
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t gaps = 0;
+        uint64_t stalls = 0;
+        uint64_t disconnects = 0;
+        uint64_t snapshots = 0;
+        uint64_t exchangeInfos = 0;
+        uint64_t serverTimes = 0;
+        uint64_t connections = 0;
+        // Stream connections closed for falling too far behind.
+        uint64_t slowConsumers = 0;
+    };
+
+    // Runs on the server thread for every event sent, just before it is
+    // queued on the subscribed connections.
+    using OnSent = std::function<void(std::string_view symbol, uint64_t lastUpdate,
+                                      std::chrono::steady_clock::time_point sentAt)>;
+
+    // Consumes the flag at argv[i] and its value if it is one of --rate,
+    // --levels, --depth, --clock-skew-ms, --gap, --stall, --stall-ms,
+    // --disconnect, --snapshot-delay-ms or --seed.
+    static bool parseFlag(Options& options, int& i, int argc, char** argv);
+
+    explicit MockExchange(Options options);
+    MockExchange(const MockExchange&) = delete;
+    MockExchange& operator=(const MockExchange&) = delete;
+    ~MockExchange();
+
+    // Issues the certificates, listens and starts the server thread; false,
+    // after logging why, if either step fails.
+    bool start();
+    void stop();
+    // Call before start().
+    void setOnSent(OnSent onSent);
+
+    uint16_t port() const {
+        return port_;
+    }
+    const std::string& caPem() const {
+        return caPem_;
+    }
+    bool writeCaFile(const std::string& path) const;
+    // Points every engine connection here.
+    BinanceHosts hosts(std::string caFile) const;
+    Stats stats() const;
+
+  private:
+    class HttpSession;
+    class StreamSession;
+
+    struct Market {
+        std::string symbol;
+        // Price and quantity in ticks and steps.
+        std::map<uint64_t, uint64_t, std::greater<>> bids;
+        std::map<uint64_t, uint64_t> asks;
+        uint64_t lastUpdate = 0;
+    };
+
+    void accept();
+    void scheduleTick();
+    void tick();
+    void emit(std::size_t index, uint64_t eventMs);
+    std::string snapshotBody(std::size_t index, std::size_t limit) const;
+    std::string exchangeInfoBody() const;
+    // Epoch milliseconds on the exchange clock.
+    uint64_t serverTimeMs() const;
+    std::optional<std::size_t> marketIndex(std::string_view symbol) const;
+    void subscribe(const std::shared_ptr<StreamSession>& session);
+    bool roll(double probability);
+    template <typename Update> void updateStats(Update update);
+
+    Options options_;
+    boost::asio::io_context io_{1};
+    boost::asio::ssl::context tls_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer timer_;
+    std::thread thread_;
+    uint16_t port_ = 0;
+    std::string caPem_;
+    OnSent onSent_;
+
+    // Server thread only.
+    std::vector<Market> markets_;
+    std::vector<std::weak_ptr<StreamSession>> subscribers_;
+    std::mt19937_64 random_;
+    std::chrono::steady_clock::time_point paceStart_;
+    uint64_t paced_ = 0;
+    std::string event_;
+
+    mutable std::mutex statsMutex_;
+    Stats stats_{};
+};
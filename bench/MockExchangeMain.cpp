@@ -0,0 +1,66 @@
+#include "MockExchange.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Serves the mock exchange until interrupted, for pointing the app at:
+//   orderbook_mock_exchange --port 9443 --ca-out mock-ca.pem BTCUSDT ETHUSDT
+//   orderbook --exchange localhost:9443 --ca-file mock-ca.pem BTCUSDT ETHUSDT
+int main(int argc, char** argv) {
+    MockExchange::Options options;
+    options.symbols.clear();
+    std::string caPath = "orderbook_mock_ca.pem";
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (MockExchange::parseFlag(options, i, argc, argv)) {
+            continue;
+        }
+        if (arg == "--port" && i + 1 < argc) {
+            options.port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--address" && i + 1 < argc) {
+            options.address = argv[++i];
+            continue;
+        }
+        if (arg == "--ca-out" && i + 1 < argc) {
+            caPath = argv[++i];
+            continue;
+        }
+        std::string symbol(arg);
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        options.symbols.push_back(std::move(symbol));
+    }
+    if (options.symbols.empty()) {
+        options.symbols.push_back("BTCUSDT");
+    }
+
+    MockExchange exchange(options);
+    if (!exchange.start() || !exchange.writeCaFile(caPath)) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "Mock exchange on " << options.address << ':' << exchange.port() << ", CA in "
+              << caPath << '\n'
+              << "  orderbook --exchange localhost:" << exchange.port() << " --ca-file " << caPath
+              << '\n';
+
+    boost::asio::io_context io;
+    boost::asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([](const boost::system::error_code&, int) {});
+    io.run();
+
+    exchange.stop();
+    const auto stats = exchange.stats();
+    std::cout << stats.messages << " events, " << stats.gaps << " gaps, " << stats.stalls
+              << " stalls, " << stats.disconnects << " disconnects, " << stats.snapshots
+              << " snapshots, " << stats.connections << " connections, " << stats.slowConsumers
+              << " slow consumers\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include "Bench.h"
+
+#include "BinanceAPIParser.h"
+#include "BootstrapArena.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+// BTCUSDT on USD-M futures: 0.10 ticks quoted to 2 places, 0.001 steps.
+constexpr SymbolScales kScales{.priceScale = 100, .qtyScale = 1000, .priceTick = 10};
+constexpr uint64_t kMid = 6'000'000;
+constexpr std::size_t kMessages = 256;
+constexpr std::size_t kSnapshotLevels = 1000;
+
+std::string formatLevel(uint64_t price, uint64_t qty) {
+    return "[\"" + BinanceAPIParser::formatScaled(price, kScales.priceScale) + "\",\"" +
+           BinanceAPIParser::formatScaled(qty, kScales.qtyScale) + "\"]";
+}
+
+std::string makeSide(std::mt19937_64& rng, std::size_t levels, bool bids, bool contiguous) {
+    std::string out = "[";
+    for (std::size_t i = 0; i < levels; ++i) {
+        const uint64_t offset = (contiguous ? i : rng() % 50) * kScales.priceTick;
+        const uint64_t price = bids ? kMid - kScales.priceTick - offset : kMid + offset;
+        const uint64_t qty = !contiguous && rng() % 4 == 0 ? 0 : 1 + rng() % 100000;
+        if (i != 0) {
+            out += ',';
+        }
+        out += formatLevel(price, qty);
+    }
+    return out + "]";
+}
+
+struct ParserInput {
+    ParserInput()
+        : parser(kScales) {
+    }
+
+    BinanceAPIParser parser;
+    // depthUpdate events as the stream sends them: 1-20 levels a side.
+    std::vector<std::string> messages;
+    std::string snapshot;
+    std::vector<uint64_t> values;
+    // Refilled by every hold call.
+    BootstrapArena arena;
+    // Holds `messages` for the decode case.
+    BootstrapArena held;
+};
+
+void holdMessages(const ParserInput& input, BootstrapArena& arena) {
+    arena.reset();
+    for (const auto& message : input.messages) {
+        const auto ids = input.parser.parseUpdateIds(message);
+        doNotOptimize(arena.append(BootstrapArena::Event{
+            .firstUpdate = ids->firstUpdate,
+            .lastUpdate = ids->lastUpdate,
+            .previousLastUpdate = ids->previousLastUpdate,
+            .raw = message,
+        }));
+    }
+}
+
+std::shared_ptr<ParserInput> makeInput() {
+    auto input = std::make_shared<ParserInput>();
+    std::mt19937_64 rng(1);
+    uint64_t lastUpdate = 1000;
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        const uint64_t first = lastUpdate + 1;
+        const uint64_t last = first + rng() % 5;
+        const std::size_t bids = 1 + rng() % 20;
+        const std::size_t asks = 1 + rng() % 20;
+        input->messages.push_back(
+            "{\"e\":\"depthUpdate\",\"E\":1700000000000,\"T\":1700000000000,"
+            "\"s\":\"BTCUSDT\",\"U\":" +
+            std::to_string(first) + ",\"u\":" + std::to_string(last) + ",\"pu\":" +
+            std::to_string(lastUpdate) + ",\"b\":" + makeSide(rng, bids, true, false) +
+            ",\"a\":" + makeSide(rng, asks, false, false) + "}");
+        lastUpdate = last;
+    }
+    input->snapshot = "{\"lastUpdateId\":1000,\"E\":1700000000000,\"T\":1700000000000,\"bids\":" +
+                      makeSide(rng, kSnapshotLevels, true, true) +
+                      ",\"asks\":" + makeSide(rng, kSnapshotLevels, false, true) + "}";
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        input->values.push_back(kMid + rng() % 100000);
+    }
+    holdMessages(*input, input->held);
+    return input;
+}
+} // namespace
+
+void addParserBenches(std::vector<BenchCase>& cases) {
+    const auto input = makeInput();
+
+    cases.push_back(BenchCase{
+        .name = "parser/delta",
+        .opsPerCall = kMessages,
+        .body =
+            [input]() {
+                for (const auto& message : input->messages) {
+                    doNotOptimize(input->parser.parseDelta(message).lastUpdate);
+                }
+            },
+    });
+    cases.push_back(BenchCase{
+        .name = "parser/depthUpdate",
+        .opsPerCall = kMessages,
+        .body =
+            [input]() {
+                for (const auto& message : input->messages) {
+                    doNotOptimize(input->parser.parseDepthUpdate(message).has_value());
+                }
+            },
+    });
+    cases.push_back(BenchCase{
+        .name = "parser/snapshot/" + std::to_string(kSnapshotLevels),
+        .body =
+            [input]() {
+                doNotOptimize(input->parser.parseSnapshot(input->snapshot).lastUpdate);
+            },
+    });
+    cases.push_back(BenchCase{
+        .name = "parser/formatScaled",
+        .opsPerCall = kMessages,
+        .body =
+            [input]() {
+                for (const uint64_t value : input->values) {
+                    doNotOptimize(BinanceAPIParser::formatScaled(value, kScales.priceScale).size());
+                }
+            },
+    });
+
+    // The bootstrap path: sequence ids decoded and the raw event held while
+    // the snapshot is pending, then the held events decoded once it lands.
+    cases.push_back(BenchCase{
+        .name = "parser/bufferedEvent/hold",
+        .opsPerCall = kMessages,
+        .body = [input]() { holdMessages(*input, input->arena); },
+    });
+    cases.push_back(BenchCase{
+        .name = "parser/bufferedEvent/decode",
+        .opsPerCall = kMessages,
+        .body =
+            [input]() {
+                for (std::size_t i = 0; i < input->held.size(); ++i) {
+                    doNotOptimize(input->parser.parseDepthUpdate(input->held[i].raw).has_value());
+                }
+            },
+    });
+}
@@ -0,0 +1,126 @@
+#include "Bench.h"
+
+#include "BinanceAPIParser.h"
+#include "OrderBook.h"
+#include "ShardedRuntime.h"
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <latch>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr std::size_t kSymbols = 64;
+constexpr std::size_t kMessagesPerSymbol = 256;
+constexpr std::size_t kLevelsPerSide = 10;
+constexpr SymbolScales kScales{.priceScale = 100, .qtyScale = 1000, .priceTick = 10};
+
+struct SymbolState {
+    explicit SymbolState(std::string name)
+        : symbol(std::move(name)), parser(kScales), book(kScales.priceTick) {
+    }
+
+    std::string symbol;
+    BinanceAPIParser parser;
+    OrderBook book;
+    std::vector<std::string> messages;
+};
+
+std::string makeSide(std::mt19937_64& rng, uint64_t mid, bool bids) {
+    std::string out = "[";
+    for (std::size_t i = 0; i < kLevelsPerSide; ++i) {
+        const uint64_t offset = (rng() % 200) * kScales.priceTick;
+        const uint64_t price = bids ? mid - kScales.priceTick - offset : mid + offset;
+        const uint64_t qty = (rng() % 4) == 0 ? 0 : rng() % 100000;
+        if (i != 0) {
+            out += ',';
+        }
+        out += "[\"" + BinanceAPIParser::formatScaled(price, kScales.priceScale) + "\",\"" +
+               BinanceAPIParser::formatScaled(qty, kScales.qtyScale) + "\"]";
+    }
+    return out + "]";
+}
+
+// depthUpdate payloads shaped like the live stream, with contiguous ids.
+void fillMessages(SymbolState& state, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    const uint64_t mid = 3000000 + (seed % 1000) * 1000;
+    uint64_t lastUpdate = 1000;
+    state.messages.reserve(kMessagesPerSymbol);
+    for (std::size_t i = 0; i < kMessagesPerSymbol; ++i) {
+        const uint64_t first = lastUpdate + 1;
+        const uint64_t last = first + rng() % 5;
+        state.messages.push_back(
+            "{\"e\":\"depthUpdate\",\"E\":1700000000000,\"T\":1700000000000,\"s\":\"" +
+            state.symbol + "\",\"U\":" + std::to_string(first) + ",\"u\":" + std::to_string(last) +
+            ",\"pu\":" + std::to_string(lastUpdate) + ",\"b\":" + makeSide(rng, mid, true) +
+            ",\"a\":" + makeSide(rng, mid, false) + "}");
+        lastUpdate = last;
+    }
+}
+
+// One runtime per shard count, with the symbols partitioned by the same
+// stable hash the engine uses. A call posts one task per shard that decodes
+// and applies every message of that shard's symbols, then waits for all.
+struct ShardFixture {
+    explicit ShardFixture(std::size_t shards)
+        : runtime(ShardedRuntime::Options{.shards = shards, .pinThreads = true}),
+          shardSymbols(shards) {
+        for (std::size_t i = 0; i < kSymbols; ++i) {
+            auto state = std::make_unique<SymbolState>("SYM" + std::to_string(i) + "USDT");
+            fillMessages(*state, i + 1);
+            shardSymbols[runtime.shardFor(state->symbol)].push_back(state.get());
+            symbols.push_back(std::move(state));
+        }
+        runtime.start();
+    }
+
+    void runOnce() {
+        std::latch done(static_cast<std::ptrdiff_t>(shardSymbols.size()));
+        for (std::size_t shard = 0; shard < shardSymbols.size(); ++shard) {
+            boost::asio::post(runtime.shard(shard), [this, shard, &done]() {
+                for (auto* state : shardSymbols[shard]) {
+                    for (const auto& message : state->messages) {
+                        if (auto event = state->parser.parseDepthUpdate(message)) {
+                            state->book.applyDelta(event->delta);
+                        }
+                    }
+                }
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+
+    ShardedRuntime runtime;
+    std::vector<std::unique_ptr<SymbolState>> symbols;
+    std::vector<std::vector<SymbolState*>> shardSymbols;
+};
+} // namespace
+
+void addShardBenches(std::vector<BenchCase>& cases) {
+    const std::size_t cores = std::max(1U, std::thread::hardware_concurrency());
+    for (std::size_t shards = 1;; shards *= 2) {
+        shards = std::min(shards, cores);
+        // Fixtures are built lazily so filtered runs do not spawn threads.
+        auto fixture = std::make_shared<std::unique_ptr<ShardFixture>>();
+        cases.push_back(BenchCase{
+            .name = "shards/" + std::to_string(shards) + "/decode+apply",
+            .opsPerCall = kSymbols * kMessagesPerSymbol,
+            .body =
+                [fixture, shards]() {
+                    if (!*fixture) {
+                        *fixture = std::make_unique<ShardFixture>(shards);
+                    }
+                    (*fixture)->runOnce();
+                },
+        });
+        if (shards == cores) {
+            break;
+        }
+    }
+}
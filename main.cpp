@@ -2,30 +2,53 @@
 #include "BinanceLiveMarketData.h"
 #include "BinanceOrderBookSync.h"
 #include "BinanceScalesSource.h"
-#include "BinanceSnapshotSource.h"
+#include "BookCheckpointWriter.h"
+#include "CaptureJournal.h"
+#include "CaptureReplay.h"
+#include "MultiSymbolEngine.h"
+#include "ShardedRuntime.h"
 #include "Renderer.h"
 #include "SfmlRenderer.h"
 
 #include <algorithm>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <cctype>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
-#include <thread>
+#include <string_view>
 #include <vector>
 
 namespace {
 constexpr std::size_t kGuiLevels = 20;
 constexpr std::size_t kTerminalLevels = 25;
+constexpr auto kBoardRefresh = std::chrono::milliseconds(500);
+constexpr auto kScalesCacheTtl = std::chrono::hours(24);
+constexpr auto kScalesRetryFirst = std::chrono::seconds(1);
+constexpr auto kScalesRetryMax = std::chrono::seconds(60);
+constexpr uint64_t kUpdateSpeedMs = 100;
 
 struct AppOptions {
-    std::string symbol = "btcusdt";
+    std::vector<std::string> symbols;
     bool useGui = false;
+    bool hugePages = false;
+    std::size_t shards = 1;
+    bool pinThreads = false;
+    std::string scalesCachePath = "orderbook_scales.cache";
+    std::size_t feeds = 1;
+    std::string captureDirectory;
+    std::string checkpointDirectory;
+    BinanceHosts hosts;
+    std::string replayDirectory;
+    CaptureReplay::Pace replayPace = CaptureReplay::Pace::MaxSpeed;
+    CaptureReplay::Faults replayFaults;
 };
 
 struct SharedGuiState {
@@ -39,16 +62,10 @@ std::string toUpperCopy(std::string value) {
     return value;
 }
 
-template <typename MapT>
-void appendFormattedTopLevels(const MapT& side, BinanceAPIParser& formatter,
-                              std::vector<std::pair<std::string, std::string>>& out,
-                              std::size_t levels) {
-    std::size_t count = 0;
-    for (const auto& [price, qty] : side) {
-        if (count++ >= levels) {
-            break;
-        }
-        out.push_back({formatter.formatPrice(price), formatter.formatQty(qty)});
+void appendFormattedLevels(const std::vector<Level>& levels, BinanceAPIParser& formatter,
+                           std::vector<std::pair<std::string, std::string>>& out) {
+    for (const auto& lvl : levels) {
+        out.push_back({formatter.formatPrice(lvl.price), formatter.formatQty(lvl.qty)});
     }
 }
 
@@ -60,15 +77,93 @@ AppOptions parseArgs(int argc, char** argv) {
             options.useGui = true;
             continue;
         }
-        options.symbol = arg;
+        if (arg == "--hugepages") {
+            options.hugePages = true;
+            continue;
+        }
+        if (arg == "--shards" && i + 1 < argc) {
+            options.shards = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--feeds" && i + 1 < argc) {
+            options.feeds = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--capture" && i + 1 < argc) {
+            options.captureDirectory = argv[++i];
+            continue;
+        }
+        // One HOST:PORT serving both REST and streams, e.g. the mock exchange.
+        if (arg == "--exchange" && i + 1 < argc) {
+            const std::string_view exchange = argv[++i];
+            const auto colon = exchange.rfind(':');
+            options.hosts.rest = std::string(exchange.substr(0, colon));
+            options.hosts.stream = options.hosts.rest;
+            if (colon != std::string_view::npos) {
+                options.hosts.restPort = std::string(exchange.substr(colon + 1));
+                options.hosts.streamPort = options.hosts.restPort;
+            }
+            continue;
+        }
+        if (arg == "--ca-file" && i + 1 < argc) {
+            options.hosts.caFile = argv[++i];
+            continue;
+        }
+        if (arg == "--checkpoint" && i + 1 < argc) {
+            options.checkpointDirectory = argv[++i];
+            continue;
+        }
+        if (arg == "--replay" && i + 1 < argc) {
+            options.replayDirectory = argv[++i];
+            continue;
+        }
+        if (arg == "--replay-pace" && i + 1 < argc) {
+            options.replayPace = std::string_view(argv[++i]) == "realtime"
+                                     ? CaptureReplay::Pace::RealTime
+                                     : CaptureReplay::Pace::MaxSpeed;
+            continue;
+        }
+        if (arg == "--replay-drop" && i + 1 < argc) {
+            options.replayFaults.dropProbability = std::strtod(argv[++i], nullptr);
+            continue;
+        }
+        if (arg == "--replay-dup" && i + 1 < argc) {
+            options.replayFaults.duplicateProbability = std::strtod(argv[++i], nullptr);
+            continue;
+        }
+        if (arg == "--replay-snapshot-delay" && i + 1 < argc) {
+            options.replayFaults.snapshotDelayFrames =
+                static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--replay-seed" && i + 1 < argc) {
+            options.replayFaults.seed = std::strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (arg == "--scales-cache" && i + 1 < argc) {
+            options.scalesCachePath = argv[++i];
+            continue;
+        }
+        if (arg == "--pin") {
+            options.pinThreads = true;
+            continue;
+        }
+        std::string symbol = toUpperCopy(arg);
+        if (std::find(options.symbols.begin(), options.symbols.end(), symbol) ==
+            options.symbols.end()) {
+            options.symbols.push_back(std::move(symbol));
+        }
+    }
+    if (options.symbols.empty()) {
+        options.symbols.push_back("BTCUSDT");
     }
-    options.symbol = toUpperCopy(options.symbol);
     return options;
 }
 
 void setGuiBookCallback(BinanceOrderBookSync& sync, SharedGuiState& shared) {
-    sync.setOnBookUpdated([&shared](const OrderBook& book, const SymbolScales& scales,
-                                    const BinanceOrderBookSync::SyncStats& stats) {
+    sync.setOnBookUpdated([&shared, top = std::vector<Level>{}](
+                              const OrderBook& book, const SymbolScales& scales,
+                              const BinanceOrderBookSync::SyncStats& stats) mutable {
         BinanceAPIParser formatter(scales);
 
         SfmlBookFrame next;
@@ -76,67 +171,246 @@ void setGuiBookCallback(BinanceOrderBookSync& sync, SharedGuiState& shared) {
         next.stats = stats;
         next.asks.reserve(kGuiLevels);
         next.bids.reserve(kGuiLevels);
-        appendFormattedTopLevels(book.getAsks(), formatter, next.asks, kGuiLevels);
-        appendFormattedTopLevels(book.getBids(), formatter, next.bids, kGuiLevels);
+        book.topAsks(kGuiLevels, top);
+        appendFormattedLevels(top, formatter, next.asks);
+        book.topBids(kGuiLevels, top);
+        appendFormattedLevels(top, formatter, next.bids);
 
         std::lock_guard<std::mutex> lock(shared.mutex);
         shared.frame = std::move(next);
     });
 }
 
-int runGuiMode(boost::asio::io_context& io, BinanceOrderBookSync& sync, std::string_view symbol) {
+// The GUI shows the first symbol; any others keep syncing in the background.
+int runGuiMode(ShardedRuntime& runtime, MultiSymbolEngine& engine) {
     SharedGuiState shared;
-    setGuiBookCallback(sync, shared);
+    setGuiBookCallback(engine.sync(0), shared);
 
-    sync.start(std::string(symbol));
-    std::thread ioThread([&io]() { io.run(); });
+    engine.start();
+    runtime.start();
 
-    SfmlRenderer renderer(std::string(symbol), kGuiLevels);
+    SfmlRenderer renderer(engine.symbol(0), kGuiLevels);
     const bool uiStarted = renderer.run(
         [&shared]() -> std::optional<SfmlBookFrame> {
             std::lock_guard<std::mutex> lock(shared.mutex);
             return shared.frame;
         },
-        [&sync, &io]() {
-            sync.stop();
-            io.stop();
+        [&engine, &runtime]() {
+            engine.stop();
+            runtime.stop();
         });
 
     if (!uiStarted) {
-        sync.stop();
-        io.stop();
-    }
-    if (ioThread.joinable()) {
-        ioThread.join();
+        engine.stop();
+        runtime.stop();
     }
+    runtime.join();
 
     return uiStarted ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-void setTerminalBookCallback(BinanceOrderBookSync& sync, std::optional<Renderer>& renderer,
-                             const std::string& symbol) {
-    sync.setOnBookUpdated([&renderer, &symbol](const OrderBook& book, const SymbolScales& scales,
-                                               const BinanceOrderBookSync::SyncStats& stats) {
-        if (!renderer) {
-            renderer.emplace(symbol, scales, kTerminalLevels);
+// Connection stats lock every feed arbiter, so they are sampled on a timer
+// rather than per delta.
+struct SampledConnection {
+    std::mutex mutex;
+    MultiSymbolEngine::ConnectionStats stats;
+};
+
+void setTerminalBookCallback(MultiSymbolEngine& engine, std::optional<Renderer>& renderer,
+                             SampledConnection& connection) {
+    engine.sync(0).setOnBookUpdated([&engine, &renderer, &connection, shown = SymbolScales{}](
+                                        const OrderBook& book, const SymbolScales& scales,
+                                        const BinanceOrderBookSync::SyncStats& stats) mutable {
+        if (!renderer || scales != shown) {
+            renderer.emplace(engine.symbol(0), scales, kTerminalLevels);
+            shown = scales;
+        }
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        renderer->render(book, stats, connection.stats);
+    });
+}
+
+void scheduleConnectionSample(boost::asio::steady_timer& timer, const MultiSymbolEngine& engine,
+                              SampledConnection& connection) {
+    timer.expires_after(kBoardRefresh);
+    timer.async_wait([&timer, &engine, &connection](const boost::system::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        auto stats = engine.connectionStats();
+        {
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            connection.stats = std::move(stats);
         }
-        renderer->render(book, stats);
+        scheduleConnectionSample(timer, engine, connection);
     });
 }
 
-int runTerminalMode(boost::asio::io_context& io, BinanceOrderBookSync& sync,
-                    const std::string& symbol) {
+void setBoardCallbacks(MultiSymbolEngine& engine, std::vector<BoardRow>& rows,
+                       std::mutex& mutex) {
+    rows.resize(engine.size());
+    for (std::size_t i = 0; i < engine.size(); ++i) {
+        rows[i].symbol = engine.symbol(i);
+        engine.sync(i).setOnBookUpdated(
+            [&row = rows[i], &mutex](const OrderBook& book, const SymbolScales& scales,
+                                     const BinanceOrderBookSync::SyncStats& stats) {
+                std::lock_guard<std::mutex> lock(mutex);
+                row.scales = scales;
+                row.bestBid = book.bestBid();
+                row.bestAsk = book.bestAsk();
+                row.lastUpdate = book.getLastUpdate();
+                row.stats = stats;
+            });
+    }
+}
+
+// Books update far more often than a terminal can usefully redraw, so the
+// board repaints on a timer rather than per delta.
+void scheduleBoardRender(boost::asio::steady_timer& timer, BoardRenderer& renderer,
+                         const MultiSymbolEngine& engine, const std::vector<BoardRow>& rows,
+                         std::mutex& mutex) {
+    timer.expires_after(kBoardRefresh);
+    timer.async_wait([&timer, &renderer, &engine, &rows,
+                      &mutex](const boost::system::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        const auto connection = engine.connectionStats();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            renderer.render(rows, connection);
+        }
+        scheduleBoardRender(timer, renderer, engine, rows, mutex);
+    });
+}
+
+// Books live on the runtime's shards; `io` only drives signals and the
+// board timer.
+int runTerminalMode(boost::asio::io_context& io, ShardedRuntime& runtime,
+                    MultiSymbolEngine& engine) {
     std::optional<Renderer> renderer;
-    setTerminalBookCallback(sync, renderer, symbol);
+    SampledConnection connection;
+    BoardRenderer boardRenderer;
+    std::vector<BoardRow> rows;
+    std::mutex rowsMutex;
+    boost::asio::steady_timer boardTimer(io);
+
+    if (engine.size() == 1) {
+        setTerminalBookCallback(engine, renderer, connection);
+        scheduleConnectionSample(boardTimer, engine, connection);
+    } else {
+        setBoardCallbacks(engine, rows, rowsMutex);
+        scheduleBoardRender(boardTimer, boardRenderer, engine, rows, rowsMutex);
+    }
 
     boost::asio::signal_set signals(io, SIGINT, SIGTERM);
     signals.async_wait([&](const boost::system::error_code&, int) {
-        sync.stop();
+        boardTimer.cancel();
+        engine.stop();
+        runtime.stop();
         io.stop();
     });
 
-    sync.start(symbol);
+    engine.start();
+    runtime.start();
+    io.run();
+    runtime.join();
+    return EXIT_SUCCESS;
+}
+
+// Runs alongside the WebSocket and REST connects; books without scales hold
+// their frames until this lands. While any book still lacks scales, a failed
+// fetch is retried with doubling backoff; books exchangeInfo does not list
+// are stopped. Both show in each book's SyncStats.
+void fetchScales(BinanceScalesSource& scalesSource, std::vector<std::string> symbols,
+                 MultiSymbolEngine& engine, std::shared_ptr<boost::asio::steady_timer> retryTimer,
+                 std::chrono::seconds backoff) {
+    scalesSource.fetchAsync(symbols, [&scalesSource, &engine, symbols, retryTimer,
+                                      backoff](auto fresh) mutable {
+        if (!fresh) {
+            std::cerr << "Binance exchangeInfo fetch failed\n";
+            if (!engine.scalesFetchFailed()) {
+                return;
+            }
+            retryTimer->expires_after(backoff);
+            retryTimer->async_wait([&scalesSource, &engine, symbols = std::move(symbols),
+                                    retryTimer, backoff](const boost::system::error_code& ec) {
+                if (!ec) {
+                    fetchScales(scalesSource, symbols, engine, retryTimer,
+                                std::min<std::chrono::seconds>(backoff * 2, kScalesRetryMax));
+                }
+            });
+            return;
+        }
+        std::vector<std::string> missing;
+        for (const auto& symbol : symbols) {
+            if (!fresh->contains(symbol)) {
+                std::cerr << "Symbol not found in exchangeInfo: " << symbol << '\n';
+                missing.push_back(symbol);
+            }
+        }
+        engine.updateScales(*fresh);
+        engine.scalesMissing(missing);
+    });
+}
+// Feeds a capture through one sync per symbol, offline: scales come from
+// the cache whatever its age, and everything runs on this thread so a run
+// is reproducible.
+int runReplayMode(const AppOptions& options) {
+    auto reader = CaptureReader::open(options.replayDirectory);
+    if (!reader) {
+        return EXIT_FAILURE;
+    }
+    const BinanceScalesSource scalesSource(
+        nullptr, ScalesCache(options.scalesCachePath, std::chrono::seconds::max()));
+    const auto scales = scalesSource.loadCached(options.symbols);
+    for (const auto& symbol : options.symbols) {
+        if (!scales.contains(symbol)) {
+            std::cerr << "No cached scales for " << symbol << " in " << options.scalesCachePath
+                      << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    boost::asio::io_context io;
+    CaptureReplay replay(io, std::move(reader), options.replayPace, options.replayFaults);
+    std::vector<std::unique_ptr<BinanceOrderBookSync>> syncs;
+    for (const auto& symbol : options.symbols) {
+        const SymbolScales symbolScales = scales.at(symbol);
+        syncs.push_back(std::make_unique<BinanceOrderBookSync>(
+            io, replay.snapshotSource(symbol, symbolScales), replay.liveMarketData(symbol),
+            symbolScales));
+        syncs.back()->start(symbol);
+    }
+
+    std::optional<CaptureReplay::Stats> result;
+    replay.start([&](const CaptureReplay::Stats& stats) {
+        result = stats;
+        for (auto& sync : syncs) {
+            sync->stop();
+        }
+    });
     io.run();
+    if (!result) {
+        return EXIT_FAILURE;
+    }
+
+    uint64_t deltas = 0;
+    for (std::size_t i = 0; i < syncs.size(); ++i) {
+        const auto& stats = syncs[i]->syncStats();
+        deltas += stats.acceptedDeltas;
+        std::cerr << options.symbols[i] << ": lastUpdate " << syncs[i]->orderBook().getLastUpdate()
+                  << ", deltas " << stats.acceptedDeltas << ", dropped " << stats.droppedDeltas
+                  << ", resyncs " << stats.resyncs << '\n';
+    }
+    const double seconds = static_cast<double>(result->elapsedNs) / 1e9;
+    std::cerr << "Replayed " << result->frames << " frames and " << result->snapshots
+              << " snapshots in " << seconds << " s ("
+              << (seconds > 0 ? static_cast<double>(result->frames) / seconds : 0.0)
+              << " msg/s, " << (deltas > 0 ? result->elapsedNs / deltas : 0)
+              << " ns/delta); injected " << result->droppedFrames << " drops, "
+              << result->duplicatedFrames << " duplicates; " << result->unusedRecords
+              << " records unused\n";
     return EXIT_SUCCESS;
 }
 } // namespace
@@ -145,16 +419,79 @@ int main(int argc, char** argv) {
     const AppOptions options = parseArgs(argc, argv);
 
     try {
+        if (!options.replayDirectory.empty()) {
+            return runReplayMode(options);
+        }
         boost::asio::io_context io;
 
-        BinanceScalesSource scalesSource;
-        const SymbolScales scales = scalesSource.getScales(options.symbol);
-        BinanceLiveMarketData liveMarketData(io);
-        BinanceSnapshotSource snapshotSource(io, options.symbol, scales);
-        BinanceOrderBookSync sync(io, snapshotSource, liveMarketData, scales);
+        NodePool::Options poolOptions;
+        poolOptions.hugePages = options.hugePages;
+        ShardedRuntime runtime(ShardedRuntime::Options{
+            .shards = options.shards,
+            .pinThreads = options.pinThreads,
+        });
+        runtime.start();
+
+        BinanceScalesSource scalesSource(
+            HttpsClient::create(runtime.shard(0),
+                                BinanceSnapshotSource::restOptions(options.hosts)),
+            ScalesCache(options.scalesCachePath, kScalesCacheTtl));
+        const auto cached = scalesSource.loadCached(options.symbols);
+
+        std::vector<MultiSymbolEngine::SymbolConfig> symbols;
+        for (const auto& symbol : options.symbols) {
+            const auto it = cached.find(symbol);
+            symbols.push_back({
+                .symbol = symbol,
+                .scales = it == cached.end() ? std::nullopt : std::optional(it->second),
+            });
+        }
+        // Redundant feeds go to distinct stream host addresses where DNS
+        // offers several.
+        std::vector<std::string> endpoints;
+        if (options.feeds > 1) {
+            endpoints = BinanceLiveMarketData::resolveAddresses(io, options.hosts);
+        }
+        std::shared_ptr<CaptureJournal> capture;
+        if (!options.captureDirectory.empty()) {
+            capture = CaptureJournal::create({.directory = options.captureDirectory});
+            if (!capture) {
+                return EXIT_FAILURE;
+            }
+        }
+        std::shared_ptr<BookCheckpointWriter> checkpoints;
+        if (!options.checkpointDirectory.empty()) {
+            checkpoints = BookCheckpointWriter::create(options.checkpointDirectory);
+            if (!checkpoints) {
+                return EXIT_FAILURE;
+            }
+        }
+        MultiSymbolEngine engine(runtime, std::move(symbols), poolOptions, kUpdateSpeedMs,
+                                 options.feeds, std::move(endpoints), capture, checkpoints,
+                                 options.hosts);
+
+        // Also revalidates a warm start: only symbols whose scales moved
+        // are resynced.
+        fetchScales(scalesSource, options.symbols, engine,
+                    std::make_shared<boost::asio::steady_timer>(runtime.shard(0)),
+                    kScalesRetryFirst);
 
-        return options.useGui ? runGuiMode(io, sync, options.symbol)
-                              : runTerminalMode(io, sync, options.symbol);
+        const int status = options.useGui ? runGuiMode(runtime, engine)
+                                          : runTerminalMode(io, runtime, engine);
+        if (capture) {
+            capture->close();
+            const auto stats = capture->stats();
+            std::cerr << "Captured " << stats.records << " records (" << stats.bytes
+                      << " bytes) in " << stats.segments << " segments, dropped "
+                      << stats.droppedRecords << '\n';
+        }
+        if (checkpoints) {
+            checkpoints->close();
+            const auto stats = checkpoints->stats();
+            std::cerr << "Wrote " << stats.written << " checkpoints, " << stats.writeErrors
+                      << " failed\n";
+        }
+        return status;
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << '\n';
         return EXIT_FAILURE;